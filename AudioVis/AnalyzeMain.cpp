@@ -0,0 +1,263 @@
+// audiovis-analyze: offline spectrum analysis of a music library.
+// Runs the same analysis as playback, with no window or GL context,
+// spreading tracks over one worker per core.
+#include "AudioVis.h"
+#include "AudioAnalyzer.h"
+#include "SpectrumCache.h"
+#include "SpectrumFile.h"
+#include "SpectrumIO.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static bool IsAudioFile(const fs::path& path)
+{
+	string ext = path.extension().string();
+	transform(ext.begin(),ext.end(),ext.begin(),::tolower);
+	return ext==".wav"||ext==".ogg"||ext==".flac";
+}
+
+static void CollectTracks(const string& arg,vector<string>& tracks)
+{
+	if(!arg.empty()&&arg[0]=='@')
+	{
+		// @list.txt: one path per line
+		ifstream list(arg.substr(1));
+		string line;
+		while(getline(list,line))
+		{
+			if(!line.empty())
+			{
+				CollectTracks(line,tracks);
+			}
+		}
+		return;
+	}
+	error_code error;
+	if(fs::is_directory(arg,error))
+	{
+		for(auto it = fs::recursive_directory_iterator(arg,error); it!=fs::recursive_directory_iterator(); it.increment(error))
+		{
+			if(it->is_regular_file(error)&&IsAudioFile(it->path()))
+			{
+				tracks.push_back(it->path().string());
+			}
+		}
+	}
+	else
+	{
+		tracks.push_back(arg);
+	}
+}
+
+static string CachePath(const string& track,const string& outDir,const char* extension)
+{
+	if(outDir.empty())
+	{
+		return track+extension;
+	}
+	// Mirror the whole absolute path so same-named tracks from different
+	// folders (or drives) don't overwrite each other
+	error_code error;
+	fs::path source = fs::absolute(track,error).lexically_normal();
+	string drive = source.root_name().string();
+	drive.erase(remove(drive.begin(),drive.end(),':'),drive.end());
+	fs::path path = fs::path(outDir)/drive/source.relative_path();
+	fs::create_directories(path.parent_path(),error);
+	return path.string()+extension;
+}
+
+static void PrintUsage()
+{
+	cout<<"usage: audiovis-analyze [-o outdir|--cache dir] [-j threads] [--split-frames] [--json|--f16|--q8] <file|directory|@list.txt>..."<<endl;
+	cout<<"       audiovis-analyze --convert <in.json> <out.avspec> [--f16|--q8]"<<endl;
+}
+
+// Rewrites a JSON spectrum (e.g. Resources/audioData.txt) as .avspec
+static int Convert(const string& input,const string& output,SpectrumFormat format)
+{
+	SpectrumData spectrum;
+	if(!LoadSpectrumJson(input,spectrum))
+	{
+		cout<<"Failed to read "<<input<<endl;
+		return 1;
+	}
+	if(!SaveSpectrumFile(spectrum,output,format))
+	{
+		cout<<"Failed to write "<<output<<endl;
+		return 1;
+	}
+	cout<<"Wrote "<<spectrum.frameCount<<" x "<<spectrum.binCount<<" frames to "<<output<<endl;
+	return 0;
+}
+
+int main(int argc,char* argv[])
+{
+	vector<string> tracks;
+	string outDir;
+	unsigned int threads = 0;
+	bool splitFrames = false;
+	bool writeJson = false;
+	SpectrumFormat format = SPECTRUM_FLOAT32;
+	string convertIn,convertOut;
+	string cacheDir;
+	for(int i = 1; i<argc; ++i)
+	{
+		string arg = argv[i];
+		if(arg=="-o"&&i+1<argc)
+		{
+			outDir = argv[++i];
+		}
+		else if(arg=="--cache"&&i+1<argc)
+		{
+			// Fill the player's content-keyed cache rather than writing beside the tracks
+			cacheDir = argv[++i];
+		}
+		else if(arg=="-j"&&i+1<argc)
+		{
+			threads = (unsigned int)atoi(argv[++i]);
+		}
+		else if(arg=="--split-frames")
+		{
+			splitFrames = true;
+		}
+		else if(arg=="--json")
+		{
+			writeJson = true;
+		}
+		else if(arg=="--f16")
+		{
+			format = SPECTRUM_FLOAT16;
+		}
+		else if(arg=="--q8")
+		{
+			format = SPECTRUM_Q8;
+		}
+		else if(arg=="--convert"&&i+2<argc)
+		{
+			convertIn = argv[++i];
+			convertOut = argv[++i];
+		}
+		else if(arg=="-h"||arg=="--help")
+		{
+			PrintUsage();
+			return 0;
+		}
+		else
+		{
+			CollectTracks(arg,tracks);
+		}
+	}
+	if(!convertIn.empty())
+	{
+		return Convert(convertIn,convertOut,format);
+	}
+	if(tracks.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+	atomic<int> done{ 0 };
+	atomic<int> failed{ 0 };
+	atomic<long long> audioMicroseconds{ 0 };
+	mutex logMutex;
+	// framePool is set when one track's frames are split over the workers
+	auto analyzeTrack = [&](const string& track,ThreadPool* framePool)
+	{
+		// Scratch buffers stay with the worker across tracks
+		thread_local AudioAnalyzer analyzer;
+		thread_local vector<sf::Int16> mono;
+		thread_local SpectrumData spectrum;
+		unsigned int sampleRate = 0;
+		bool ok = AudioAnalyzer::LoadMono(track,mono,sampleRate);
+		if(ok&&sampleRate<SPECTRUM_FRAME_RATE)
+		{
+			// The hop would be zero
+			lock_guard<mutex> lock(logMutex);
+			cout<<"Sample rate "<<sampleRate<<" is below "<<SPECTRUM_FRAME_RATE<<" Hz: "<<track<<endl;
+			ok = false;
+		}
+		if(ok)
+		{
+			int hop = sampleRate/SPECTRUM_FRAME_RATE;
+			if(framePool)
+			{
+				AudioAnalyzer::AnalyzeTrackParallel(mono.data(),mono.size(),sampleRate,hop,spectrum,*framePool);
+			}
+			else
+			{
+				analyzer.AnalyzeTrack(mono.data(),mono.size(),sampleRate,hop,spectrum);
+			}
+			if(!cacheDir.empty())
+			{
+				SpectrumCache cache(cacheDir);
+				ok = cache.Store(SpectrumCache::MakeKey(mono.data(),mono.size(),sampleRate,hop,analyzer),spectrum);
+			}
+			else if(writeJson)
+			{
+				ok = SaveSpectrumJson(spectrum,CachePath(track,outDir,SPECTRUM_JSON_EXTENSION));
+			}
+			else
+			{
+				ok = SaveSpectrumFile(spectrum,CachePath(track,outDir,SPECTRUM_CACHE_EXTENSION),format);
+			}
+		}
+		if(ok)
+		{
+			audioMicroseconds += (long long)(mono.size()*1000000.0/sampleRate);
+		}
+		else
+		{
+			++failed;
+			lock_guard<mutex> lock(logMutex);
+			cout<<"Failed: "<<track<<endl;
+		}
+		int count = ++done;
+		if(count%100==0)
+		{
+			lock_guard<mutex> lock(logMutex);
+			cout<<count<<"/"<<tracks.size()<<endl;
+		}
+	};
+
+	auto start = chrono::steady_clock::now();
+	{
+		ThreadPool pool(threads);
+		cout<<"Analysing "<<tracks.size()<<" tracks on "<<pool.GetThreadCount()<<" threads"<<endl;
+		if(splitFrames||tracks.size()<pool.GetThreadCount())
+		{
+			// Too few tracks to fill the cores: parallelise within each track instead
+			for(const string& track:tracks)
+			{
+				analyzeTrack(track,&pool);
+			}
+		}
+		else
+		{
+			for(const string& track:tracks)
+			{
+				pool.Submit([&,track]
+				{
+					analyzeTrack(track,nullptr);
+				});
+			}
+			pool.Wait();
+		}
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+	double audioHours = audioMicroseconds/1000000.0/3600.0;
+	cout<<"Analysed "<<done-failed<<" tracks ("<<failed<<" failed), "<<audioHours<<" audio-hours in "<<seconds<<"s"<<endl;
+	cout<<"Throughput: "<<(seconds>0 ? audioHours/seconds : 0)<<" audio-hours per wall-second"<<endl;
+	return failed>0 ? 2 : 0;
+}
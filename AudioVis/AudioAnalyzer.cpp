@@ -0,0 +1,195 @@
+#include "AudioAnalyzer.h"
+#include "ThreadPool.h"
+#include "SFML/Audio/InputSoundFile.hpp"
+
+#include <cmath>
+
+AudioAnalyzer::AudioAnalyzer(int fftSize,int binCount)
+	: m_FFTSize(fftSize),m_BinCount(binCount)
+{
+	m_Window.resize(m_FFTSize);
+	for(int i = 0; i<m_FFTSize; ++i)
+	{
+		m_Window[i] = 0.54-0.46*cos(2*M_PI*i/(double)m_FFTSize);
+	}
+	// Bands split the positive frequency bins (skipping DC) evenly
+	int usable = m_FFTSize/2-1;
+	m_BandStart.resize(m_BinCount+1);
+	for(int b = 0; b<=m_BinCount; ++b)
+	{
+		m_BandStart[b] = 1+(int)((long long)usable*b/m_BinCount);
+	}
+	m_Data.resize(m_FFTSize);
+}
+
+void AudioAnalyzer::Analyze(const sf::Int16* samples,float* spectrum)
+{
+	for(int i = 0; i<m_FFTSize; ++i)
+	{
+		m_Data[i] = complexVal(samples[i]*m_Window[i],0);
+	}
+	fft(m_Data);
+
+	// fft() scales by 1/sqrt(N); this brings a full scale sine to roughly 0dB
+	double fullScale = 32768.0*0.5*sqrt((double)m_FFTSize);
+	for(int b = 0; b<m_BinCount; ++b)
+	{
+		int first = m_BandStart[b];
+		int last = std::max(m_BandStart[b+1],first+1);
+		double sum = 0;
+		for(int k = first; k<last; ++k)
+		{
+			sum += std::abs(m_Data[k]);
+		}
+		double db = 20.0*log10(sum/(last-first)/fullScale+1e-12);
+		double value = (db-SPECTRUM_MIN_DB)/(SPECTRUM_MAX_DB-SPECTRUM_MIN_DB);
+		spectrum[b] = (float)(value<0 ? 0 : (value>1 ? 1 : value));
+	}
+}
+
+void AudioAnalyzer::AnalyzeTrack(const sf::Int16* samples,size_t sampleCount,int sampleRate,int hop,SpectrumData& out)
+{
+	PrepareTrack(sampleCount,sampleRate,hop,m_BinCount,out);
+	AnalyzeFrames(samples,sampleCount,out,0,out.frameCount);
+}
+
+void AudioAnalyzer::AnalyzeTrackParallel(const sf::Int16* samples,size_t sampleCount,int sampleRate,int hop,SpectrumData& out,ThreadPool& pool,int fftSize,int binCount)
+{
+	PrepareTrack(sampleCount,sampleRate,hop,binCount,out);
+	// A few chunks per worker keeps them all busy to the end
+	int chunkCount = (int)pool.GetThreadCount()*4;
+	int chunkFrames = std::max(1,(out.frameCount+chunkCount-1)/chunkCount);
+	SpectrumData* dest = &out;
+	for(int first = 0; first<out.frameCount; first += chunkFrames)
+	{
+		int last = std::min(first+chunkFrames,out.frameCount);
+		pool.Submit([=]
+		{
+			AudioAnalyzer analyzer(fftSize,binCount);
+			analyzer.AnalyzeFrames(samples,sampleCount,*dest,first,last);
+		});
+	}
+	pool.Wait();
+}
+
+void AudioAnalyzer::PrepareTrack(size_t sampleCount,int sampleRate,int hop,int binCount,SpectrumData& out)
+{
+	out.binCount = binCount;
+	out.hop = hop;
+	out.sampleRate = sampleRate;
+	out.frameCount = (int)((sampleCount+hop-1)/hop);
+	out.frames.resize((size_t)out.frameCount*binCount);
+}
+
+void AudioAnalyzer::AnalyzeFrames(const sf::Int16* samples,size_t sampleCount,SpectrumData& out,int firstFrame,int lastFrame)
+{
+	m_Padded.resize(m_FFTSize);
+	for(int f = firstFrame; f<lastFrame; ++f)
+	{
+		size_t start = (size_t)f*out.hop;
+		float* dest = &out.frames[(size_t)f*m_BinCount];
+		if(start+m_FFTSize<=sampleCount)
+		{
+			Analyze(samples+start,dest);
+		}
+		else
+		{
+			// The last windows run past the end of the track; pad with silence
+			size_t available = sampleCount-start;
+			std::copy(samples+start,samples+sampleCount,m_Padded.begin());
+			std::fill(m_Padded.begin()+available,m_Padded.end(),(sf::Int16)0);
+			Analyze(m_Padded.data(),dest);
+		}
+	}
+}
+
+bool AudioAnalyzer::LoadMono(const std::string& path,std::vector<sf::Int16>& mono,unsigned int& sampleRate)
+{
+	sf::InputSoundFile file;
+	if(!file.openFromFile(path))
+	{
+		return false;
+	}
+	unsigned int channels = file.getChannelCount();
+	std::vector<sf::Int16> interleaved((size_t)file.getSampleCount());
+	interleaved.resize((size_t)file.read(interleaved.data(),interleaved.size()));
+	sampleRate = file.getSampleRate();
+	if(channels==1)
+	{
+		mono.swap(interleaved);
+	}
+	else
+	{
+		Downmix(interleaved.data(),interleaved.size()/channels,channels,mono);
+	}
+	return true;
+}
+
+void AudioAnalyzer::Downmix(const sf::Int16* interleaved,size_t frameCount,unsigned int channels,std::vector<sf::Int16>& mono)
+{
+	mono.resize(frameCount);
+	for(size_t i = 0; i<frameCount; ++i)
+	{
+		int sum = 0;
+		for(unsigned int c = 0; c<channels; ++c)
+		{
+			sum += interleaved[i*channels+c];
+		}
+		mono[i] = (sf::Int16)(sum/(int)channels);
+	}
+}
+
+// Cooley-Turkey FFT
+// (in-place, breadth-first, decimation-in-frequency)
+// Taken from rosettacode.org
+// https://rosettacode.org/wiki/Fast_Fourier_transform#C.2B.2B
+void AudioAnalyzer::fft(complexArray& data)
+{
+	// DFT
+	unsigned int N = data.size(), k = N, n;
+	double thetaT = M_PI / N;
+	complexVal phiT = complexVal(cos(thetaT), -sin(thetaT)), T;
+	while (k > 1)
+	{
+		n = k;
+		k >>= 1;
+		phiT = phiT * phiT;
+		T = 1.0L;
+		for (unsigned int l = 0; l < k; l++)
+		{
+			for (unsigned int a = l; a < N; a += n)
+			{
+				unsigned int b = a + k;
+				complexVal t = data[a] - data[b];
+				data[a] += data[b];
+				data[b] = t * T;
+			}
+			T *= phiT;
+		}
+	}
+
+	// Decimate
+	unsigned int m = (unsigned int)log2(N);
+	for (unsigned int a = 0; a < N; a++)
+	{
+		unsigned int b = a;
+		// Reverse bits
+		b = (((b & 0xaaaaaaaa) >> 1) | ((b & 0x55555555) << 1));
+		b = (((b & 0xcccccccc) >> 2) | ((b & 0x33333333) << 2));
+		b = (((b & 0xf0f0f0f0) >> 4) | ((b & 0x0f0f0f0f) << 4));
+		b = (((b & 0xff00ff00) >> 8) | ((b & 0x00ff00ff) << 8));
+		b = ((b >> 16) | (b << 16)) >> (32 - m);
+		if (b > a)
+		{
+			complexVal t = data[a];
+			data[a] = data[b];
+			data[b] = t;
+		}
+	}
+	// Normalize
+	complexVal f = 1.0 / sqrt(N);
+	for (unsigned int i = 0; i < N; i++)
+	{
+		data[i] *= f;
+	}
+}
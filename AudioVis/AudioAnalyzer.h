@@ -0,0 +1,111 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+#include "AudioVis.h"
+#include "SFML/Config.hpp"
+
+#include <valarray>
+#include <complex>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+typedef std::complex<double>		complexVal;
+typedef std::valarray<complexVal>	complexArray;
+
+//==============================================================
+// A track's spectrum frames, frameCount x binCount, row major.
+// Frame i was analysed from the window starting at sample i*hop.
+//==============================================================
+struct SpectrumData
+{
+	int frameCount{ 0 };
+	int binCount{ 0 };
+	int hop{ 0 };
+	int sampleRate{ 0 };
+	std::vector<float> frames;
+
+	const float* GetFrame(int index) const
+	{
+		return &frames[(size_t)index*binCount];
+	}
+
+	// Frame covering the given mono sample position, clamped to the track
+	int FrameAt(double samplePosition) const
+	{
+		if(frameCount==0||hop<=0)
+		{
+			return -1;
+		}
+		int index = (int)(samplePosition/hop);
+		return index<0 ? 0 : (index>=frameCount ? frameCount-1 : index);
+	}
+};
+
+// Frame index for a time in seconds. Frames are evenly spaced, so this is
+// O(1) for any length of track; spectra without a hop are taken to be at
+// SPECTRUM_DEFAULT_FRAME_RATE. Clamped to the track unless loop is set.
+inline int SpectrumFrameAtTime(double seconds,int sampleRate,int hop,int frameCount,bool loop = false)
+{
+	if(frameCount<=0)
+	{
+		return -1;
+	}
+	double framesPerSecond = hop>0&&sampleRate>0 ? (double)sampleRate/hop : SPECTRUM_DEFAULT_FRAME_RATE;
+	long long index = (long long)(seconds*framesPerSecond);
+	if(loop)
+	{
+		index %= frameCount;
+		return (int)(index<0 ? index+frameCount : index);
+	}
+	return (int)(index<0 ? 0 : (index>=frameCount ? frameCount-1 : index));
+}
+
+//==============================================================
+// Windowed FFT of a mono sample window reduced to a spectrum
+// frame of binCount values in [0,1]. Holds its own scratch, so
+// use one instance per thread.
+//==============================================================
+class AudioAnalyzer
+{
+public:
+	explicit AudioAnalyzer(int fftSize = BUFFER_SIZE,int binCount = SPECTRUM_BIN_COUNT);
+
+	int GetFFTSize() const
+	{
+		return m_FFTSize;
+	}
+
+	int GetBinCount() const
+	{
+		return m_BinCount;
+	}
+
+	// Reads fftSize samples, writes binCount values
+	void Analyze(const sf::Int16* samples,float* spectrum);
+
+	// Analyses a whole mono track at the given hop into out
+	void AnalyzeTrack(const sf::Int16* samples,size_t sampleCount,int sampleRate,int hop,SpectrumData& out);
+
+	// Same result as AnalyzeTrack, but the frame range is split into chunks
+	// analysed concurrently on the pool, each with its own analyzer scratch.
+	// Must not be called from a job running on the same pool.
+	static void AnalyzeTrackParallel(const sf::Int16* samples,size_t sampleCount,int sampleRate,int hop,SpectrumData& out,ThreadPool& pool,int fftSize = BUFFER_SIZE,int binCount = SPECTRUM_BIN_COUNT);
+
+	// Decodes a file and downmixes it to mono
+	static bool LoadMono(const std::string& path,std::vector<sf::Int16>& mono,unsigned int& sampleRate);
+	static void Downmix(const sf::Int16* interleaved,size_t frameCount,unsigned int channels,std::vector<sf::Int16>& mono);
+	static void fft(complexArray& data);
+
+private:
+	static void PrepareTrack(size_t sampleCount,int sampleRate,int hop,int binCount,SpectrumData& out);
+	void AnalyzeFrames(const sf::Int16* samples,size_t sampleCount,SpectrumData& out,int firstFrame,int lastFrame);
+
+	int m_FFTSize;
+	int m_BinCount;
+	std::vector<double> m_Window;
+	std::vector<int> m_BandStart;
+	complexArray m_Data;
+	std::vector<sf::Int16> m_Padded;
+};
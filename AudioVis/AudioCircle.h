@@ -8,6 +8,8 @@
 
 #include "AudioVis.h"
 #include "DrawBase.h"
+#include "PolarBasis.h"
+#include "SpectrumTexture.h"
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
@@ -27,13 +29,20 @@ public:
 	virtual bool Init()override;
 
 	virtual void Draw(Visualizer* visualizer)override;
-private:
-	unsigned int GenVAO(const std::vector<float>& heigthlist);
-	void GetVetexData(const std::vector<float>& heigthlist);
+
+	virtual void Release()override;
 private:
 	GLuint shader;
-	GLuint MVPID;
-	std::vector<glm::vec3> m_Vertexdata;
-	std::vector <int> m_Indices;
+	GLuint m_FirstID;
+	GLuint m_CountID;
+	// Set on each draw: the program is shared by source with other shapes
+	GLint m_ModelID{ -1 };
+	GLint m_BasisID{ -1 };
+	GLint m_OutlineID{ -1 };
+	GLint m_CenterColorID{ -1 };
+	GLint m_RimColorID{ -1 };
+	glm::mat4 m_Model{ 1.0f };
+	// The fan is built in Shaders/Circle.vs from the heights alone
+	SpectrumTexture m_Heights;
 };
 
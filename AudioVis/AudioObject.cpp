@@ -1,4 +1,8 @@
 #include "AudioObject.h"
+#include "CaptureSource.h"
+#include "SpectrumCache.h"
+
+#include <chrono>
 
 AudioObject::AudioObject(string const& path, int const& bufferSize)
 {
@@ -6,19 +10,85 @@ AudioObject::AudioObject(string const& path, int const& bufferSize)
 	sampleBufferSize = bufferSize;
 }
 
+AudioObject::AudioObject(CaptureSource* source, int const& bufferSize, unsigned int rate)
+{
+	capture = source;
+	sampleBufferSize = bufferSize;
+	captureRate = rate;
+}
+
 bool AudioObject::Init()
 {
-	if (!buffer.loadFromFile(filePath))
+	if (capture)
 	{
-		cout << "Unable to load buffer" << endl;
-		return false;
+		if (!capture->Start(captureRate))
+		{
+			cout << "Unable to start capture" << endl;
+			return false;
+		}
+		sampleRate = capture->GetSampleRate();
+		sampleCount = 0;
+		captureWindow.assign(sampleBufferSize, 0);
+		captureScratch.resize(sampleBufferSize);
+		// The same analysis as the file path, so every source yields alike frames
+		captureAnalyzer = AudioAnalyzer(sampleBufferSize);
+		captureFrame.assign(captureAnalyzer.GetBinCount(), 0.0f);
 	}
-	sound.setBuffer(buffer);
-	sampleRate = buffer.getSampleRate() * buffer.getChannelCount();
-	sampleCount = buffer.getSampleCount();
-	if (sampleBufferSize > sampleCount)
+	else
 	{
-		sampleBufferSize = sampleCount;
+		{
+			// The header alone says how long the track is
+			InputSoundFile file;
+			if (!file.openFromFile(filePath))
+			{
+				cout << "Unable to load buffer" << endl;
+				return false;
+			}
+			unsigned int hop = file.getSampleRate() / SPECTRUM_FRAME_RATE;
+			double spectrumBytes = hop > 0 ? (double)(file.getSampleCount() / file.getChannelCount()) / hop * SPECTRUM_BIN_COUNT * sizeof(float) : 0;
+			streamed = spectrumBytes >= SPECTRUM_STREAM_THRESHOLD;
+		}
+		if (streamed)
+		{
+			// Long sessions keep fixed windows resident: the audio plays from
+			// disk and the spectrum is analysed into the cache a chunk at a
+			// time, then streamed back from it
+			if (!music.openFromFile(filePath))
+			{
+				cout << "Unable to load buffer" << endl;
+				return false;
+			}
+			string spectrumPath;
+			if (!SpectrumCache().LoadFile(filePath, spectrumPath) || !spectrumStream.Open(spectrumPath))
+			{
+				cout << "Unable to analyse " << filePath << endl;
+			}
+			sampleRate = music.getSampleRate() * music.getChannelCount();
+			sampleCount = 0;
+		}
+		else
+		{
+			if (!buffer.loadFromFile(filePath))
+			{
+				cout << "Unable to load buffer" << endl;
+				return false;
+			}
+			sound.setBuffer(buffer);
+			// Tracks played before map their cached spectrum instead of being analysed
+			// again; the mono copy only lives until then
+			vector<Int16> mono;
+			AudioAnalyzer::Downmix(buffer.getSamples(), buffer.getSampleCount() / buffer.getChannelCount(), buffer.getChannelCount(), mono);
+			if (!SpectrumCache().Load(mono.data(), mono.size(), buffer.getSampleRate(), spectrum))
+			{
+				cout << "Unable to analyse " << filePath << endl;
+			}
+			sampleRate = buffer.getSampleRate() * buffer.getChannelCount();
+			sampleCount = buffer.getSampleCount();
+		}
+		if (sampleBufferSize > sampleCount)
+		{
+			sampleBufferSize = sampleCount;
+		}
 	}
 	ConstructWindow();
 	samples.resize(sampleBufferSize);
@@ -31,97 +101,163 @@ bool AudioObject::Init()
 void AudioObject::PlaySound()
 {
 	frameNumber = 0;
-	sound.play();
+	if (streamed)
+	{
+		music.play();
+	}
+	else if (!capture)
+	{
+		sound.play();
+	}
 }
 
 bool AudioObject::IsPlaying()
 {
+	if (capture)
+	{
+		return capture->IsRunning();
+	}
+	if (streamed)
+	{
+		return music.getStatus() != SoundSource::Status::Stopped;
+	}
 	return sound.getStatus() != SoundSource::Status::Stopped;
 }
 
-void AudioObject::ConstructWindow()
+unsigned long long AudioObject::GetDataPosition() const
 {
-	for (int i = 0; i < sampleBufferSize; ++i)
+	if (capture)
 	{
-		windowCache.push_back(0.54 - 0.46 * cos(2 * M_PI * i / (float)sampleBufferSize));
+		return capture->GetRing().GetWritePosition();
+	}
+	// Keyed on the spectrum frame, so a paused or between-frames track
+	// isn't redrawn just because the playing offset moved a little
+	double seconds = GetPlayingTime();
+	int frame = spectrumStream.IsOpen() ? spectrumStream.FrameAtTime(seconds) : spectrum.FrameAtTime(seconds);
+	if (frame < 0)
+	{
+		frame = (int)(seconds * SPECTRUM_FRAME_RATE);
 	}
+	return (unsigned long long)frame;
 }
 
-void AudioObject::CollectSamples()
+double AudioObject::GetPlayingTime() const
 {
-	frameNumber = sound.getPlayingOffset().asSeconds() * sampleRate;
-	if (frameNumber + sampleBufferSize < sampleCount)
+	if (capture)
 	{
-		for (int i = 0; i < sampleBufferSize; ++i)
+		// The capture clock
+		return sampleRate > 0 ? (double)capture->GetRing().GetWritePosition() / sampleRate : 0;
+	}
+	return (streamed ? music.getPlayingOffset() : sound.getPlayingOffset()).asSeconds();
+}
+
+void AudioObject::Seek(double seconds)
+{
+	if (capture)
+	{
+		return;
+	}
+	Time duration = streamed ? music.getDuration() : buffer.getDuration();
+	double last = max(duration.asSeconds() - SEEK_END_MARGIN_SECONDS, 0.0);
+	seconds = seconds < 0 ? 0 : (seconds > last ? last : seconds);
+	// CollectSamples reads from the playing offset, so the FFT window follows
+	if (streamed)
+	{
+		music.setPlayingOffset(sf::seconds((float)seconds));
+	}
+	else
+	{
+		sound.setPlayingOffset(sf::seconds((float)seconds));
+	}
+	if (spectrumStream.IsOpen())
+	{
+		// Read the frame's chunk now so the next frame drawn is not blank,
+		// then read ahead from there
+		spectrumStream.Preload(spectrumStream.FrameAtTime(seconds));
+	}
+}
+
+FrameSpan AudioObject::GetSpectrumFrame()
+{
+	if (capture)
+	{
+		if (captureWindowEnd != captureMeasuredEnd)
 		{
-			// We use a complex value, but the imaginary component is always zero
-			samples[i] = complexVal(buffer.getSamples()[frameNumber + i] * windowCache[i], 0);
+			long long pushed = capture->GetRing().GetPushTime(captureWindowEnd);
+			long long now = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+			captureLatency = pushed > 0 ? (now - pushed) / 1000000000.0 : 0;
+			captureMeasuredEnd = captureWindowEnd;
 		}
+		return FrameSpan(captureFrame);
 	}
+	if (spectrumStream.IsOpen())
+	{
+		return spectrumStream.GetFrame(spectrumStream.FrameAtTime(GetPlayingTime()));
+	}
+	if (!spectrum.IsOpen() || spectrum.GetFrameCount() == 0)
+	{
+		return FrameSpan();
+	}
+	return FrameSpan(spectrum.GetFrame(spectrum.FrameAtTime(GetPlayingTime())), spectrum.GetBinCount());
 }
 
-// Cooley-Turkey FFT 
-// (in-place, breadth-first, decimation-in-frequency)
-// Taken from rosettacode.org
-// https://rosettacode.org/wiki/Fast_Fourier_transform#C.2B.2B
-void AudioObject::fft(complexArray& data)
+void AudioObject::ConstructWindow()
 {
-	// DFT
-	unsigned int N = data.size(), k = N, n;
-	double thetaT = M_PI / N;
-	complexVal phiT = complexVal(cos(thetaT), -sin(thetaT)), T;
-	while (k > 1)
-	{
-		n = k;
-		k >>= 1;
-		phiT = phiT * phiT;
-		T = 1.0L;
-		for (unsigned int l = 0; l < k; l++)
+	for (int i = 0; i < sampleBufferSize; ++i)
+	{
+		windowCache.push_back(0.54 - 0.46 * cos(2 * M_PI * i / (float)sampleBufferSize));
+	}
+}
+
+void AudioObject::CollectSamples()
+{
+	if (capture)
+	{
+		// The capture thread never waits on us; if it keeps lapping the copy,
+		// draw the previous window again rather than stall the render thread
+		for (int attempt = 0; attempt < CAPTURE_READ_RETRIES; ++attempt)
 		{
-			for (unsigned int a = l; a < N; a += n)
+			unsigned long long end = 0;
+			if (capture->GetRing().ReadLatest(captureScratch.data(), sampleBufferSize, &end))
 			{
-				unsigned int b = a + k;
-				complexVal t = data[a] - data[b];
-				data[a] += data[b];
-				data[b] = t * T;
+				captureWindow.swap(captureScratch);
+				captureWindowEnd = end;
+				return;
 			}
-			T *= phiT;
 		}
+		++captureRetries;
+		return;
 	}
-
-	// Decimate
-	unsigned int m = (unsigned int)log2(N);
-	for (unsigned int a = 0; a < N; a++)
+	frameNumber = sound.getPlayingOffset().asSeconds() * sampleRate;
+	if (frameNumber + sampleBufferSize < sampleCount)
 	{
-		unsigned int b = a;
-		// Reverse bits
-		b = (((b & 0xaaaaaaaa) >> 1) | ((b & 0x55555555) << 1));
-		b = (((b & 0xcccccccc) >> 2) | ((b & 0x33333333) << 2));
-		b = (((b & 0xf0f0f0f0) >> 4) | ((b & 0x0f0f0f0f) << 4));
-		b = (((b & 0xff00ff00) >> 8) | ((b & 0x00ff00ff) << 8));
-		b = ((b >> 16) | (b << 16)) >> (32 - m);
-		if (b > a)
+		for (int i = 0; i < sampleBufferSize; ++i)
 		{
-			complexVal t = data[a];
-			data[a] = data[b];
-			data[b] = t;
+			// We use a complex value, but the imaginary component is always zero
+			samples[i] = complexVal(buffer.getSamples()[frameNumber + i] * windowCache[i], 0);
 		}
 	}
-	// Normalize
-	complexVal f = 1.0 / sqrt(N);
-	for (unsigned int i = 0; i < N; i++)
-	{
-		data[i] *= f;
-	}
 }
 
 void AudioObject::Update()
 {
 	// Collect samples for this frame
 	CollectSamples();
+	if (capture)
+	{
+		// Live frames come from the analyser alone; the buckets below are
+		// only kept for file playback
+		captureAnalyzer.Analyze(captureWindow.data(), captureFrame.data());
+		return;
+	}
+	if (streamed)
+	{
+		// No decoded samples are held to bucket; the frames come from the spectrum stream
+		return;
+	}
 	// Perform FFT on samples
 	data = complexArray(samples.data(), sampleBufferSize);
-	fft(data);
+	AudioAnalyzer::fft(data);
 	// Clear and reserve the number of output buckets we will need 
 	// Probably wont impact perf, but good habits don't hurt
 	outputBuckets.clear();
@@ -2,18 +2,18 @@
 
 #define _USE_MATH_DEFINES
 #include "AudioVis.h"
+#include "AudioAnalyzer.h"
+#include "FrameSpan.h"
+#include "SpectrumFile.h"
+#include "SpectrumStream.h"
 #include "SFML/Graphics.hpp"
 #include "SFML/Audio.hpp"
 
-#include <valarray>
-#include <complex>
+class CaptureSource;
 
 using namespace std;
 using namespace sf;
 
-typedef complex<double>			complexVal;
-typedef valarray<complexVal>	complexArray;
-
 //==============================================================
 // A class to wrap all the DPS and FFT processes for a .wav file
 //==============================================================
@@ -22,6 +22,8 @@ class AudioObject
 public:
 
 	AudioObject(string const& path,int const& bufferSize);
+	// Live mode: analyses whatever the capture source has pushed into its ring
+	AudioObject(CaptureSource* source,int const& bufferSize,unsigned int rate = 44100);
 	~AudioObject()
 	{
 	};
@@ -41,18 +43,77 @@ public:
 		return m_Heights;
 	}
 
+	// Seconds into the track, or of audio captured so far in live mode
+	double GetPlayingTime() const;
+	// Moves playback, and with it the analysis window and spectrum frame, to
+	// the given time. The next Update already reflects the new position,
+	// and a streamed spectrum has the new frame loaded.
+	void Seek(double seconds);
+
+	// Changes whenever there is something new to draw: the ring write
+	// position when live, the spectrum frame index for a file
+	unsigned long long GetDataPosition() const;
+
+	bool IsLive() const
+	{
+		return capture!=nullptr;
+	}
+
+	// Whole-track spectrum, mapped from the analysis cache; closed in live
+	// mode and for tracks long enough to be streamed instead
+	const SpectrumFile& GetSpectrum() const
+	{
+		return spectrum;
+	}
+
+	// Spectrum frame at the current playing offset, or in live mode the
+	// frame the last Update analysed from the newest captured window.
+	// Empty while a streamed chunk is still loading.
+	FrameSpan GetSpectrumFrame();
+
+	// Seconds from the newest sample of the live window being pushed into
+	// the ring to GetSpectrumFrame first handing out its frame
+	double GetCaptureLatency() const
+	{
+		return captureLatency;
+	}
+
+	// Frames whose window could not be copied cleanly, so the previous one was kept
+	int GetCaptureRetries() const
+	{
+		return captureRetries;
+	}
+
 private:
 
 	void ConstructWindow();
 	void CollectSamples();
-	void fft(complexArray& data);
 
 	//--------------------------------------------------------------
 	// Media management courtesy of SFML
 	//--------------------------------------------------------------
 	Sound		sound;
 	SoundBuffer buffer;
+	// Long tracks play from disk instead, so memory stays fixed however long they are
+	Music		music;
+	bool		streamed{ false };
 	string		filePath;
+	SpectrumFile spectrum;
+	SpectrumStream spectrumStream;
+
+	//--------------------------------------------------------------
+	// Live capture input
+	//--------------------------------------------------------------
+	CaptureSource*		capture{ nullptr };
+	unsigned int		captureRate{ 44100 };
+	vector<Int16>		captureWindow;
+	vector<Int16>		captureScratch;
+	AudioAnalyzer		captureAnalyzer;
+	vector<float>		captureFrame;
+	unsigned long long	captureWindowEnd{ 0 };		// ring position just past the window
+	unsigned long long	captureMeasuredEnd{ 0 };
+	double				captureLatency{ 0 };
+	int					captureRetries{ 0 };
 
 	//--------------------------------------------------------------
 	// For FFT and windowing functions
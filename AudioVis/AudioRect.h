@@ -7,6 +7,7 @@
 
 #include "AudioVis.h"
 #include "DrawBase.h"
+#include "BarRenderer.h"
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
@@ -28,11 +29,9 @@ public:
 
 	virtual void Draw(Visualizer* visualizer)override;
 
+	virtual void Release()override;
+
 private:
-	unsigned int GenVAO(const std::vector<float>& heigthlist);
-	std::vector<glm::vec3> GetVetexData(const std::vector<float>& heigthlist);
-private:
-	GLuint shader;
-	GLuint MVPID;
+	BarRenderer m_Bars;
 };
 
@@ -8,6 +8,9 @@
 
 #include "AudioVis.h"
 #include "DrawBase.h"
+#include "PolarBasis.h"
+#include "RadialBars.h"
+#include "SpectrumTexture.h"
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
@@ -27,12 +30,13 @@ public:
 	virtual bool Init()override;
 
 	virtual void Draw(Visualizer* visualizer)override;
+
+	virtual void Release()override;
 private:
-	unsigned int GenVAO(const std::vector<float>& heigthlist);
-	void GetVetexData(const std::vector<float>& heigthlist);
-private:
-	GLuint shader;
-	GLuint MVPID;
-	std::vector<glm::vec3> m_Vertexdata;
+	// The bars are built in Shaders/RadialBars.vs from the heights alone
+	RadialBarProgram m_Bars;
+	RadialBarStyle m_Style;
+	glm::mat4 m_Model{ 1.0f };
+	SpectrumTexture m_Heights;
 };
 
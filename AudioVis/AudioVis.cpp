@@ -1,13 +1,313 @@
 #include "AudioVis.h"
 #include "AudioObject.h"
+#include "CaptureSource.h"
+#include "FrameScheduler.h"
+#include "Playlist.h"
+#include "SpectrumNet.h"
+#include "SpectrumShm.h"
 #include "Visualizer.h"
 
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <thread>
+
 using namespace std;
 
+// Headless run of the live path against a replayed file: reports how long it
+// takes from the newest sample of a window being captured to that window's
+// spectrum frame being handed out
+static int RunCaptureBench(const string& path)
+{
+	ReplayCapture replay(path);
+	AudioObject audio(&replay, BUFFER_SIZE);
+	if (!audio.Init())
+	{
+		return 1;
+	}
+	int frames = 0;
+	double total = 0;
+	double worst = 0;
+	unsigned long long lastPos = 0;
+	auto start = chrono::steady_clock::now();
+	while (audio.IsPlaying())
+	{
+		unsigned long long pos = replay.GetRing().GetWritePosition();
+		if (pos == lastPos)
+		{
+			this_thread::yield();
+			continue;
+		}
+		lastPos = pos;
+		audio.Update();
+		if (audio.GetSpectrumFrame().empty() || audio.GetCaptureLatency() <= 0)
+		{
+			continue;
+		}
+		total += audio.GetCaptureLatency();
+		worst = std::max(worst, audio.GetCaptureLatency());
+		++frames;
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << "Capture bench: " << frames << " frames in " << seconds << "s, " << audio.GetCaptureRetries() << " windows re-used after failed reads" << endl;
+	if (frames > 0)
+	{
+		cout << "Capture to spectrum latency: mean " << total / frames * 1000.0 << "ms, max " << worst * 1000.0 << "ms" << endl;
+	}
+	return 0;
+}
+
+//==============================================================
+// Frame pacing options shared by every render loop
+//==============================================================
+struct FrameOptions
+{
+	double fps{ 0 };			// 0: the monitor's refresh rate
+	bool onNewData{ false };	// skip frames with no new audio
+	bool vsync{ true };
+	double benchSeconds{ 0 };	// > 0: compare against an unpaced loop and report CPU use
+	string publishName;			// non-empty: share each spectrum frame under this name
+	string sendAddress;			// non-empty: send each spectrum frame to this host[:port]
+};
+
+// Where spectrum frames go besides the screen
+struct FrameOutputs
+{
+	string publishName;
+	SpectrumPublisher publisher;
+	bool publishFailed{ false };
+	SpectrumSender sender;
+
+	explicit FrameOutputs(const FrameOptions& options)
+		: publishName(options.publishName)
+	{
+		if (!options.sendAddress.empty())
+		{
+			sender.Open(options.sendAddress);
+		}
+	}
+
+	// Hands the frame to other processes. The shared ring is sized by the first
+	// frame and recreated if a later track has a different bin count; once
+	// it can't be opened, publishing stays off.
+	void Publish(FrameSpan frame, double time)
+	{
+		if (frame.empty())
+		{
+			return;
+		}
+		if (!publishName.empty() && !publishFailed && publisher.GetBinCount() != (int)frame.size())
+		{
+			// Opened once per bin count; a failure isn't retried every frame
+			publishFailed = !publisher.Open(publishName, (int)frame.size());
+		}
+		if (publisher.IsOpen())
+		{
+			publisher.Publish(frame.data(), time);
+		}
+		if (sender.IsOpen())
+		{
+			// One frame per render, so sent straight away rather than held for a batch
+			sender.Send(frame.data(), (int)frame.size(), time);
+			sender.Flush();
+		}
+	}
+};
+
+// Renders until the source stops, or for `seconds` when > 0. Returns the share of one core used.
+static double RunFrames(const function<bool()>& isPlaying, const function<unsigned long long()>& dataPosition, const function<void()>& renderFrame,
+	Visualizer& visualizer, FrameScheduler& scheduler, double seconds = 0)
+{
+	auto start = chrono::steady_clock::now();
+	double cpuStart = FrameScheduler::GetProcessCpuSeconds();
+	double elapsed = 0;
+	while (isPlaying() && (seconds <= 0 || elapsed < seconds))
+	{
+		if (scheduler.WaitNextFrame(dataPosition()))
+		{
+			renderFrame();
+		}
+		else
+		{
+			visualizer.PollEvents();
+		}
+		elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+	return elapsed > 0 ? (FrameScheduler::GetProcessCpuSeconds() - cpuStart) / elapsed : 0;
+}
+
+static void RunWithOptions(const function<bool()>& isPlaying, const function<unsigned long long()>& dataPosition, const function<void()>& renderFrame,
+	Visualizer& visualizer, const FrameOptions& options)
+{
+	double fps = options.fps > 0 ? options.fps : visualizer.GetRefreshRate();
+	if (options.benchSeconds > 0)
+	{
+		// The old behaviour: no pacing, no vsync, every iteration renders
+		visualizer.SetVsync(false);
+		FrameScheduler unpaced(0);
+		double busy = RunFrames(isPlaying, dataPosition, renderFrame, visualizer, unpaced, options.benchSeconds);
+		cout << "Unpaced: " << unpaced.GetRenderedFrames() / options.benchSeconds << " fps, " << busy * 100.0 << "% CPU" << endl;
+
+		visualizer.SetVsync(options.vsync);
+		FrameScheduler paced(fps, options.onNewData);
+		double used = RunFrames(isPlaying, dataPosition, renderFrame, visualizer, paced, options.benchSeconds);
+		cout << "Paced at " << fps << " fps: " << paced.GetRenderedFrames() / options.benchSeconds << " fps rendered, "
+			<< paced.GetSkippedFrames() << " skipped, " << used * 100.0 << "% CPU" << endl;
+		if (busy > 0)
+		{
+			cout << "CPU saved: " << (1.0 - used / busy) * 100.0 << "%" << endl;
+		}
+		return;
+	}
+	visualizer.SetVsync(options.vsync);
+	FrameScheduler scheduler(fps, options.onNewData);
+	RunFrames(isPlaying, dataPosition, renderFrame, visualizer, scheduler);
+}
+
+// Plays the tracks back to back; the next one is decoded and analysed while the current one plays
+static int RunPlaylist(const vector<string>& tracks, bool loop, const FrameOptions& options)
+{
+	Playlist playlist(tracks, loop);
+	if (!playlist.Start())
+	{
+		cout << "Error: Could not start playlist" << endl;
+		return 0;
+	}
+	Visualizer visualizer(1280, 720);
+	if (!visualizer.Init())
+	{
+		cout << "Error opening OpenGL renderer" << endl;
+		return 0;
+	}
+	FrameOutputs outputs(options);
+	// Update runs every iteration so a format change restart isn't held up by skipped frames
+	RunWithOptions([&]
+		{
+			playlist.Update();
+			return playlist.IsPlaying();
+		},
+		[&] { return playlist.GetDataPosition(); },
+		[&]
+		{
+			int binCount = 0;
+			const float* frame = playlist.GetCurrentSpectrum(&binCount);
+			FrameSpan span(frame, frame ? binCount : 0);
+			double time = playlist.GetPlayingTime();
+			outputs.Publish(span, time);
+			// The current track's own spectrum, not the bundled one
+			visualizer.Update(span, time);
+		},
+		visualizer, options);
+	return 0;
+}
+
 int main(int argc, char* argv[])
 {
-	string wavPath = "FeelNoWays.wav";
-	AudioObject audio("Resources/" + wavPath, BUFFER_SIZE);
+	// The bundled track; paths from the command line are used as given
+	string wavPath = "Resources/FeelNoWays.wav";
+	vector<string> tracks;
+	bool loop = false;
+	FrameOptions frameOptions;
+	unique_ptr<CaptureSource> capture;
+	for (int i = 1; i < argc; ++i)
+	{
+		string arg = argv[i];
+		if (arg == "--capture")
+		{
+			capture.reset(new DeviceCapture());
+		}
+		else if (arg == "--capture-device" && i + 1 < argc)
+		{
+			capture.reset(new DeviceCapture(argv[++i]));
+		}
+		else if (arg == "--replay" && i + 1 < argc)
+		{
+			capture.reset(new ReplayCapture(argv[++i]));
+		}
+		else if (arg == "--capture-bench" && i + 1 < argc)
+		{
+			return RunCaptureBench(argv[++i]);
+		}
+		else if (arg == "--playlist" && i + 1 < argc)
+		{
+			// One path per line
+			ifstream list(argv[++i]);
+			string line;
+			while (getline(list, line))
+			{
+				if (!line.empty())
+				{
+					tracks.push_back(line);
+				}
+			}
+		}
+		else if (arg == "--loop")
+		{
+			loop = true;
+		}
+		else if (arg == "--fps" && i + 1 < argc)
+		{
+			frameOptions.fps = atof(argv[++i]);
+		}
+		else if (arg == "--on-new-data")
+		{
+			frameOptions.onNewData = true;
+		}
+		else if (arg == "--no-vsync")
+		{
+			frameOptions.vsync = false;
+		}
+		else if (arg == "--bench-frames" && i + 1 < argc)
+		{
+			frameOptions.benchSeconds = atof(argv[++i]);
+		}
+		else if (arg == "--publish")
+		{
+			frameOptions.publishName = SPECTRUM_SHM_NAME;
+		}
+		else if (arg == "--publish-name" && i + 1 < argc)
+		{
+			frameOptions.publishName = argv[++i];
+		}
+		else if (arg == "--send" && i + 1 < argc)
+		{
+			frameOptions.sendAddress = argv[++i];
+		}
+		else if (arg == "--sink")
+		{
+			// Stand-in consumer for --send 127.0.0.1
+			SpectrumSink sink;
+			if (!sink.Open(SPECTRUM_NET_PORT))
+			{
+				return 1;
+			}
+			sink.Run(0);
+			return 0;
+		}
+		else if (arg == "--subscribe")
+		{
+			// Stand-in consumer for --publish
+			SpectrumMonitor monitor;
+			monitor.Run(SPECTRUM_SHM_NAME, 0);
+			return 0;
+		}
+		else
+		{
+			tracks.push_back(arg);
+		}
+	}
+	if (!capture && (tracks.size() > 1 || loop))
+	{
+		return RunPlaylist(tracks, loop, frameOptions);
+	}
+	if (tracks.size() == 1)
+	{
+		wavPath = tracks[0];
+	}
+
+	unique_ptr<AudioObject> audioPtr(capture ? new AudioObject(capture.get(), BUFFER_SIZE) : new AudioObject(wavPath, BUFFER_SIZE));
+	AudioObject& audio = *audioPtr;
 	if (audio.Init())
 	{
 		audio.PlaySound();
@@ -25,11 +325,21 @@ int main(int argc, char* argv[])
 		cout << "Error opening OpenGL renderer" << endl;
 		return 0;
 	}
-	// Just play audio if not debugging
-	while (audio.IsPlaying())
-	{
-		audio.Update();
-		visualizer.Update(audio);
-	}
+	FrameOutputs outputs(frameOptions);
+	RunWithOptions([&] { return audio.IsPlaying(); },
+		[&] { return audio.GetDataPosition(); },
+		[&]
+		{
+			double seek = visualizer.TakeSeekRequest();
+			if (seek != 0)
+			{
+				audio.Seek(audio.GetPlayingTime() + seek);
+			}
+			audio.Update();
+			// Live frames are analysed just like a file's, so consumers see the same bins either way
+			outputs.Publish(audio.GetSpectrumFrame(), audio.GetPlayingTime());
+			visualizer.Update(audio);
+		},
+		visualizer, frameOptions);
 	return 0;
 }
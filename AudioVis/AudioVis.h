@@ -17,4 +17,116 @@
 #define OUTPUT_BUCKET_COUNT 4
 
 // How fast we want to rotate our model in degrees/zec
-#define ROTATION_SPEED 1
\ No newline at end of file
+#define ROTATION_SPEED 1
+
+// Capacity in samples of the lock-free ring a live capture source pushes into
+#define CAPTURE_RING_SIZE (BUFFER_SIZE*4)
+
+// How often the capture device hands us samples, in milliseconds
+#define CAPTURE_INTERVAL_MS 5
+
+// Samples per push for the file replay stand-in device
+#define CAPTURE_CHUNK_SIZE 256
+
+// Recent pushes whose arrival time the capture ring remembers, for latency
+#define CAPTURE_PUSH_RECORDS 64
+
+// Copies of the capture window tried per frame before the previous one is kept
+#define CAPTURE_READ_RETRIES 3
+
+// Number of bands in an analysed spectrum frame (matches Resources/audioData.txt)
+#define SPECTRUM_BIN_COUNT 256
+
+// Spectrum frames computed per second of audio when analysing a whole track
+#define SPECTRUM_FRAME_RATE 60
+
+// Decibel range mapped onto [0,1] in a spectrum frame
+#define SPECTRUM_MIN_DB -90.0f
+#define SPECTRUM_MAX_DB -10.0f
+
+// Sample frames handed to the audio device per playlist stream chunk
+#define PLAYLIST_CHUNK_FRAMES 4096
+
+// Frame rate assumed for spectra that do not record a hop (audioData.txt)
+#define SPECTRUM_DEFAULT_FRAME_RATE 60
+
+// Seconds the arrow keys scrub by
+#define SEEK_STEP_SECONDS 5.0
+
+// Seeks stop this many seconds short of the end of the track, so a
+// scrub past it does not stop playback and close the window
+#define SEEK_END_MARGIN_SECONDS 1.0
+
+// Suffix of the per-track spectrum cache written by audiovis-analyze
+#define SPECTRUM_CACHE_EXTENSION ".avspec"
+
+// Suffix of the same cache in the older JSON layout (audiovis-analyze --json)
+#define SPECTRUM_JSON_EXTENSION ".spectrum.json"
+
+// Frames per compressed block in a .avspec file
+#define SPECTRUM_BLOCK_FRAMES 16
+
+// Decoded blocks kept per open .avspec file
+#define SPECTRUM_CACHE_BLOCKS 4
+
+// Where AudioObject keeps analysed spectra, keyed by audio content
+#define SPECTRUM_CACHE_DIR "Cache"
+
+// Bump whenever AudioAnalyzer's window, band layout or scaling changes,
+// so cached spectra from older builds are not reused
+#define SPECTRUM_ANALYSIS_VERSION 1
+
+// Frames per chunk read by SpectrumStream (about four seconds)
+#define SPECTRUM_STREAM_CHUNK_FRAMES 256
+
+// Decoded chunks SpectrumStream keeps resident, and how many of them
+// it reads ahead of the playback position
+#define SPECTRUM_STREAM_CHUNKS 8
+#define SPECTRUM_STREAM_AHEAD 3
+
+// Tracks whose spectrum would be at least this large are played through
+// sf::Music and analysed to disk in chunks rather than decoded into memory
+#define SPECTRUM_STREAM_THRESHOLD (64*1024*1024)
+
+// Name of the shared memory ring spectrum frames are published to
+#define SPECTRUM_SHM_NAME "audiovis-spectrum"
+
+// Frames kept in the shared memory ring
+#define SPECTRUM_SHM_SLOTS 8
+
+// Default UDP port spectrum datagrams are sent to
+#define SPECTRUM_NET_PORT 47017
+
+// Datagrams SpectrumSender queues before sending them in one call
+#define SPECTRUM_NET_BATCH 16
+
+// Frames a StreamBuffer cycles through before reusing a region, so the
+// CPU writes one frame while the GPU may still be drawing the two before
+#define STREAM_BUFFER_FRAMES 3
+
+// Starting size in bytes of each StreamBuffer region
+#define STREAM_BUFFER_SIZE (64*1024)
+
+// Uniform buffer binding point of the Frame block every shader shares
+#define FRAME_UNIFORM_BINDING 0
+
+// A frame this many times louder than the running average is a beat
+#define BEAT_ONSET_RATIO 1.4f
+
+// Seconds beats must be apart to count, and the longest gap still
+// taken as the beat length
+#define BEAT_MIN_INTERVAL 0.25
+#define BEAT_MAX_INTERVAL 2.0
+
+// Weight of each frame in the running loudness average
+#define BEAT_AVERAGE_WEIGHT 0.05f
+
+// Where linked shader programs are kept between runs, and their suffix
+#define SHADER_CACHE_DIR SPECTRUM_CACHE_DIR
+#define SHADER_CACHE_EXTENSION ".glprog"
+
+// Spectrum frames SpectrumPyramid keeps the levels of at once
+#define SPECTRUM_PYRAMID_CACHE_FRAMES 8
+
+// Sample frames decoded at a time when a long track is analysed straight from its file
+#define SPECTRUM_DECODE_FRAMES 65536
@@ -0,0 +1,78 @@
+#include "BarRenderer.h"
+#include "Shader.hpp"
+
+// [0,1]x[0,1] as a four vertex triangle strip
+static const float s_UnitQuad[] =
+{
+	0,0, 1,0,
+	0,1, 1,1
+};
+
+bool BarRenderer::Init()
+{
+	m_Program = LoadShaders("Shaders/Bars.vs","Shaders/AudioRect.fs");
+	if(m_Program==0||!m_HeightBuffer.Init())
+	{
+		return false;
+	}
+	m_ModelID = glGetUniformLocation(m_Program,"uModel");
+	m_WidthID = glGetUniformLocation(m_Program,"uBarWidth");
+	m_StepID = glGetUniformLocation(m_Program,"uBarStep");
+	m_HeightScaleID = glGetUniformLocation(m_Program,"uHeightScale");
+	m_BottomColorID = glGetUniformLocation(m_Program,"uBottomColor");
+	m_TopColorID = glGetUniformLocation(m_Program,"uTopColor");
+
+	glGenVertexArrays(1,&m_VAO);
+	glBindVertexArray(m_VAO);
+
+	glGenBuffers(1,&m_QuadBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER,m_QuadBuffer);
+	glBufferData(GL_ARRAY_BUFFER,sizeof(s_UnitQuad),s_UnitQuad,GL_STATIC_DRAW);
+	glVertexAttribPointer(0,2,GL_FLOAT,GL_FALSE,2*sizeof(float),(void*)0);
+	glEnableVertexAttribArray(0);
+
+	// The offset into the height buffer is set per draw
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1,1);
+	return true;
+}
+
+void BarRenderer::Release()
+{
+	if(m_VAO)
+	{
+		glDeleteVertexArrays(1,&m_VAO);
+		m_VAO = 0;
+	}
+	if(m_QuadBuffer)
+	{
+		glDeleteBuffers(1,&m_QuadBuffer);
+		m_QuadBuffer = 0;
+	}
+	// The program belongs to the shader cache
+	m_Program = 0;
+	m_HeightBuffer.Release();
+}
+
+void BarRenderer::Draw(const glm::mat4& model,FrameSpan heights,const BarStyle& style)
+{
+	GLint first = m_HeightBuffer.Upload(heights.data(),heights.size(),sizeof(float));
+	if(first<0)
+	{
+		return;
+	}
+	glUseProgram(m_Program);
+	glUniformMatrix4fv(m_ModelID,1,GL_FALSE,&model[0][0]);
+	glUniform1f(m_WidthID,style.width);
+	glUniform1f(m_StepID,style.step);
+	glUniform1f(m_HeightScaleID,style.heightScale);
+	glUniform3fv(m_BottomColorID,1,&style.bottomColor[0]);
+	glUniform3fv(m_TopColorID,1,&style.topColor[0]);
+
+	glBindVertexArray(m_VAO);
+	// GL 3.3 has no base instance, so the attribute is pointed at this frame's heights
+	glBindBuffer(GL_ARRAY_BUFFER,m_HeightBuffer.GetBuffer());
+	glVertexAttribPointer(1,1,GL_FLOAT,GL_FALSE,sizeof(float),(void*)(first*sizeof(float)));
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP,0,4,(GLsizei)heights.size());
+	m_HeightBuffer.EndFrame();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "FrameSpan.h"
+#include "StreamBuffer.h"
+#include "glm/glm.hpp"
+
+//==============================================================
+// Placement and colours of a row of bars. Bar i spans
+// [i*step, i*step+width] and rises height*heightScale, shaded from
+// bottomColor at its foot to topColor at its top.
+//==============================================================
+struct BarStyle
+{
+	float width{ 0.25f };
+	float step{ 0.5f };
+	float heightScale{ 1.0f };
+	glm::vec3 bottomColor{ 1.0f,0.0f,0.0f };
+	glm::vec3 topColor{ 1.0f,0.0f,0.0f };
+};
+
+//==============================================================
+// Draws one bar per height as an instance of a static unit quad.
+// Only the heights are uploaded each frame, four bytes a bar, and
+// the vertex shader places and scales the quad.
+//==============================================================
+class BarRenderer
+{
+public:
+	bool Init();
+	void Release();
+
+	// Once per frame: the height buffer moves on to its next region.
+	// The camera comes from the shared Frame block.
+	void Draw(const glm::mat4& model,FrameSpan heights,const BarStyle& style);
+
+private:
+	GLuint m_Program{ 0 };
+	GLuint m_ModelID{ 0 };
+	GLuint m_WidthID{ 0 };
+	GLuint m_StepID{ 0 };
+	GLuint m_HeightScaleID{ 0 };
+	GLuint m_BottomColorID{ 0 };
+	GLuint m_TopColorID{ 0 };
+	GLuint m_VAO{ 0 };
+	GLuint m_QuadBuffer{ 0 };
+	StreamBuffer m_HeightBuffer;
+};
@@ -0,0 +1,110 @@
+#include "CaptureSource.h"
+#include "AudioAnalyzer.h"
+
+#include <chrono>
+
+DeviceCapture::DeviceCapture(const std::string& device)
+	: m_Device(device)
+{
+	// SFML's default of 100ms per chunk alone would blow the latency budget
+	setProcessingInterval(sf::milliseconds(CAPTURE_INTERVAL_MS));
+}
+
+DeviceCapture::~DeviceCapture()
+{
+	// SoundRecorder requires derived classes to stop before they are destroyed
+	Stop();
+}
+
+bool DeviceCapture::Start(unsigned int sampleRate)
+{
+	if(!sf::SoundRecorder::isAvailable())
+	{
+		std::cout<<"No audio capture device available"<<std::endl;
+		return false;
+	}
+	if(!m_Device.empty()&&!setDevice(m_Device))
+	{
+		std::cout<<"Unable to open capture device "<<m_Device<<std::endl;
+		return false;
+	}
+	setChannelCount(1);
+	m_SampleRate = sampleRate;
+	m_Ring.Reset();
+	m_Running = start(sampleRate);
+	return m_Running;
+}
+
+void DeviceCapture::Stop()
+{
+	if(m_Running)
+	{
+		stop();
+		m_Running = false;
+	}
+}
+
+bool DeviceCapture::onProcessSamples(const sf::Int16* samples,std::size_t sampleCount)
+{
+	OnSamples(samples,sampleCount);
+	return true;
+}
+
+ReplayCapture::ReplayCapture(const std::string& path,std::size_t chunkSize,bool paced)
+	: m_Path(path),m_ChunkSize(chunkSize),m_Paced(paced)
+{
+}
+
+ReplayCapture::~ReplayCapture()
+{
+	Stop();
+}
+
+bool ReplayCapture::Start(unsigned int sampleRate)
+{
+	Stop();
+	sf::SoundBuffer buffer;
+	if(!buffer.loadFromFile(m_Path))
+	{
+		std::cout<<"Unable to load replay file "<<m_Path<<std::endl;
+		return false;
+	}
+	// Downmix up front so the replay thread only copies, like a mono device would deliver
+	unsigned int channels = buffer.getChannelCount();
+	AudioAnalyzer::Downmix(buffer.getSamples(),buffer.getSampleCount()/channels,channels,m_Mono);
+	m_SampleRate = buffer.getSampleRate();
+	m_Ring.Reset();
+	m_Delivered = 0;
+	m_Running = true;
+	m_Thread = std::thread(&ReplayCapture::Run,this);
+	return true;
+}
+
+void ReplayCapture::Stop()
+{
+	m_Running = false;
+	if(m_Thread.joinable())
+	{
+		m_Thread.join();
+	}
+}
+
+void ReplayCapture::Run()
+{
+	auto start = std::chrono::steady_clock::now();
+	std::size_t offset = 0;
+	while(m_Running&&offset<m_Mono.size())
+	{
+		std::size_t count = std::min(m_ChunkSize,m_Mono.size()-offset);
+		if(m_Paced)
+		{
+			// A device hands over a chunk once it has been fully recorded
+			auto due = start+std::chrono::nanoseconds((long long)((offset+count)*1000000000.0/m_SampleRate));
+			std::this_thread::sleep_until(due);
+		}
+		OnSamples(&m_Mono[offset],count);
+		offset += count;
+		m_Delivered = offset;
+	}
+	m_Running = false;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "SampleRing.h"
+#include "SFML/Audio.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+//==============================================================
+// A live sample source feeding a SampleRing. The only work done
+// on the delivery thread is a lock-free push into the ring.
+//==============================================================
+class CaptureSource
+{
+public:
+	CaptureSource()
+		: m_Ring(CAPTURE_RING_SIZE)
+	{
+	}
+	virtual ~CaptureSource()
+	{
+	}
+
+	virtual bool Start(unsigned int sampleRate) = 0;
+	virtual void Stop() = 0;
+	virtual bool IsRunning() const = 0;
+
+	// Samples per second of the (mono) stream pushed into the ring
+	unsigned int GetSampleRate() const
+	{
+		return m_SampleRate;
+	}
+
+	const SampleRing& GetRing() const
+	{
+		return m_Ring;
+	}
+
+protected:
+	void OnSamples(const sf::Int16* samples,std::size_t sampleCount)
+	{
+		m_Ring.Push(samples,sampleCount);
+	}
+
+	SampleRing m_Ring;
+	unsigned int m_SampleRate{ 0 };
+};
+
+//==============================================================
+// Captures from the default (or named) recording device
+//==============================================================
+class DeviceCapture:public CaptureSource,private sf::SoundRecorder
+{
+public:
+	explicit DeviceCapture(const std::string& device = "");
+	virtual ~DeviceCapture();
+
+	virtual bool Start(unsigned int sampleRate)override;
+	virtual void Stop()override;
+	virtual bool IsRunning() const override
+	{
+		return m_Running;
+	}
+
+private:
+	virtual bool onProcessSamples(const sf::Int16* samples,std::size_t sampleCount)override;
+
+	std::string m_Device;
+	std::atomic<bool> m_Running{ false };
+};
+
+//==============================================================
+// Deterministic stand-in for a capture device: replays a decoded
+// file in fixed-size chunks, either paced in real time or as fast
+// as possible. Needs no audio hardware, so latency and throughput
+// can be measured on headless machines.
+//==============================================================
+class ReplayCapture:public CaptureSource
+{
+public:
+	ReplayCapture(const std::string& path,std::size_t chunkSize = CAPTURE_CHUNK_SIZE,bool paced = true);
+	virtual ~ReplayCapture();
+
+	// The file's own rate is used; the argument is ignored
+	virtual bool Start(unsigned int sampleRate)override;
+	virtual void Stop()override;
+	virtual bool IsRunning() const override
+	{
+		return m_Running;
+	}
+
+	// Number of samples delivered so far
+	unsigned long long GetDelivered() const
+	{
+		return m_Delivered;
+	}
+
+private:
+	void Run();
+
+	std::string m_Path;
+	std::size_t m_ChunkSize;
+	bool m_Paced;
+	std::vector<sf::Int16> m_Mono;
+	std::thread m_Thread;
+	std::atomic<bool> m_Running{ false };
+	std::atomic<unsigned long long> m_Delivered{ 0 };
+};
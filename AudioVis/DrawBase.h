@@ -1,5 +1,7 @@
 #pragma once
 
+#include "FrameSpan.h"
+
 class AudioObject;
 class Visualizer;
 
@@ -12,9 +14,11 @@ public:
 	virtual void Draw(const AudioObject& audioObject,const Visualizer& visualizer)
 	{
 	}
+	// Draws the frame visualizer->GetCurrentFrame()
 	virtual void Draw(Visualizer* visualizer)=0;
-protected:
-	int m_Framecount;
-	int m_TotalNum = 636;
+	// Frees the GL objects made in Init while the context is still current
+	virtual void Release()
+	{
+	}
 };
 
@@ -0,0 +1,94 @@
+#include "FrameScheduler.h"
+
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib,"winmm.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+FrameScheduler::FrameScheduler(double targetFps,bool renderOnNewData)
+	: m_RenderOnNewData(renderOnNewData)
+{
+#ifdef _WIN32
+	// The default 15.6ms timer tick is coarser than a 60fps frame
+	timeBeginPeriod(1);
+#endif
+	SetTargetFps(targetFps);
+}
+
+FrameScheduler::~FrameScheduler()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FrameScheduler::SetTargetFps(double targetFps)
+{
+	if(targetFps>0)
+	{
+		m_Interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0/targetFps));
+	}
+	else
+	{
+		m_Interval = Clock::duration(0);
+	}
+	m_Deadline = Clock::now();
+}
+
+bool FrameScheduler::WaitNextFrame(unsigned long long dataPosition)
+{
+	if(m_Interval.count()>0)
+	{
+		m_Deadline += m_Interval;
+		Clock::time_point now = Clock::now();
+		if(m_Deadline<now)
+		{
+			// We fell behind (slow frame, window dragged...): don't try to catch up
+			m_Deadline = now;
+		}
+		else
+		{
+			std::this_thread::sleep_until(m_Deadline);
+		}
+	}
+	if(m_RenderOnNewData&&m_HasLastData&&dataPosition==m_LastData)
+	{
+		++m_Skipped;
+		return false;
+	}
+	m_HasLastData = true;
+	m_LastData = dataPosition;
+	++m_Rendered;
+	return true;
+}
+
+double FrameScheduler::GetProcessCpuSeconds()
+{
+#ifdef _WIN32
+	FILETIME creation,exit,kernel,user;
+	if(!GetProcessTimes(GetCurrentProcess(),&creation,&exit,&kernel,&user))
+	{
+		return 0;
+	}
+	auto toSeconds = [](const FILETIME& time)
+	{
+		ULARGE_INTEGER value;
+		value.LowPart = time.dwLowDateTime;
+		value.HighPart = time.dwHighDateTime;
+		return value.QuadPart/10000000.0;
+	};
+	return toSeconds(kernel)+toSeconds(user);
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+	return usage.ru_utime.tv_sec+usage.ru_utime.tv_usec/1000000.0+usage.ru_stime.tv_sec+usage.ru_stime.tv_usec/1000000.0;
+#endif
+}
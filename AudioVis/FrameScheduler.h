@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+
+//==============================================================
+// Paces the render loop instead of letting it spin. Each call to
+// WaitNextFrame sleeps until the next frame deadline (1/targetFps
+// after the previous one). With renderOnNewData set, a deadline
+// where the spectrum source has not advanced is skipped entirely.
+//==============================================================
+class FrameScheduler
+{
+public:
+	// targetFps <= 0 disables pacing (the old busy loop)
+	explicit FrameScheduler(double targetFps = 60.0,bool renderOnNewData = false);
+	~FrameScheduler();
+
+	void SetTargetFps(double targetFps);
+	void SetRenderOnNewData(bool renderOnNewData)
+	{
+		m_RenderOnNewData = renderOnNewData;
+	}
+
+	// Blocks until the next deadline. dataPosition is any counter that
+	// changes when a new spectrum frame is available. Returns false if
+	// this frame should be skipped.
+	bool WaitNextFrame(unsigned long long dataPosition);
+
+	int GetRenderedFrames() const
+	{
+		return m_Rendered;
+	}
+
+	int GetSkippedFrames() const
+	{
+		return m_Skipped;
+	}
+
+	// CPU time used by the whole process so far, in seconds
+	static double GetProcessCpuSeconds();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::duration m_Interval{ 0 };
+	Clock::time_point m_Deadline;
+	bool m_RenderOnNewData;
+	bool m_HasLastData{ false };
+	unsigned long long m_LastData{ 0 };
+	int m_Rendered{ 0 };
+	int m_Skipped{ 0 };
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+//==============================================================
+// Non-owning view of one spectrum frame. Valid as long as the
+// store it points into (Visualizer, a vector) is alive.
+//==============================================================
+class FrameSpan
+{
+public:
+	FrameSpan()
+	{
+	}
+
+	FrameSpan(const float* data,size_t size)
+		: m_Data(data),m_Size(size)
+	{
+	}
+
+	FrameSpan(const std::vector<float>& values)
+		: m_Data(values.data()),m_Size(values.size())
+	{
+	}
+
+	const float* data() const
+	{
+		return m_Data;
+	}
+
+	size_t size() const
+	{
+		return m_Size;
+	}
+
+	bool empty() const
+	{
+		return m_Size==0;
+	}
+
+	const float* begin() const
+	{
+		return m_Data;
+	}
+
+	const float* end() const
+	{
+		return m_Data+m_Size;
+	}
+
+	const float& operator[](size_t index) const
+	{
+		return m_Data[index];
+	}
+
+private:
+	const float* m_Data{ nullptr };
+	size_t m_Size{ 0 };
+};
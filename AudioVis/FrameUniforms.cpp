@@ -0,0 +1,62 @@
+#include "FrameUniforms.h"
+
+#include <algorithm>
+
+static_assert(sizeof(FrameBlock)==3*64+16,"FrameBlock must match the std140 Frame block");
+
+bool FrameUniforms::Init()
+{
+	glGenBuffers(1,&m_Buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER,m_Buffer);
+	glBufferData(GL_UNIFORM_BUFFER,sizeof(FrameBlock),&m_Block,GL_STREAM_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER,FRAME_UNIFORM_BINDING,m_Buffer);
+	return m_Buffer!=0;
+}
+
+void FrameUniforms::Release()
+{
+	if(m_Buffer)
+	{
+		glDeleteBuffers(1,&m_Buffer);
+		m_Buffer = 0;
+	}
+}
+
+void FrameUniforms::SetCamera(const glm::mat4& view,const glm::mat4& projection)
+{
+	m_Block.view = view;
+	m_Block.projection = projection;
+	m_Block.viewProjection = projection*view;
+}
+
+void FrameUniforms::Update(double time,float loudness)
+{
+	// A beat is a frame well above the running average, not too soon
+	// after the last; the gap between the last two sets the beat length
+	if(loudness>m_AverageLoudness*BEAT_ONSET_RATIO&&time-m_LastBeat>=BEAT_MIN_INTERVAL)
+	{
+		if(m_LastBeat>=0&&time-m_LastBeat<BEAT_MAX_INTERVAL)
+		{
+			m_BeatInterval = time-m_LastBeat;
+		}
+		m_LastBeat = time;
+	}
+	m_AverageLoudness += (loudness-m_AverageLoudness)*BEAT_AVERAGE_WEIGHT;
+
+	m_Block.time = (float)time;
+	m_Block.loudness = loudness;
+	m_Block.beatPhase = m_LastBeat<0 ? 1.0f : (float)std::min((time-m_LastBeat)/m_BeatInterval,1.0);
+
+	// Orphans last frame's copy rather than waiting on draws still reading it
+	glBindBuffer(GL_UNIFORM_BUFFER,m_Buffer);
+	glBufferData(GL_UNIFORM_BUFFER,sizeof(FrameBlock),&m_Block,GL_STREAM_DRAW);
+}
+
+void FrameUniforms::Attach(GLuint program)
+{
+	GLuint block = glGetUniformBlockIndex(program,"Frame");
+	if(block!=GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(program,block,FRAME_UNIFORM_BINDING);
+	}
+}
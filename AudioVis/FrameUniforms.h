@@ -0,0 +1,62 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+//==============================================================
+// What every shader needs to know about the frame, laid out as
+// the std140 block they all declare:
+//
+//   layout(std140) uniform Frame
+//   {
+//       mat4 uView;
+//       mat4 uProjection;
+//       mat4 uViewProjection;
+//       float uTime;        seconds since start
+//       float uLoudness;    mean of the frame's heights
+//       float uBeatPhase;   0 on a beat, rising to 1 by the next
+//   };
+//
+// The block is uploaded once per frame and sits on binding point
+// FRAME_UNIFORM_BINDING, so programs only set their own model.
+//==============================================================
+struct FrameBlock
+{
+	glm::mat4 view{ 1.0f };
+	glm::mat4 projection{ 1.0f };
+	glm::mat4 viewProjection{ 1.0f };
+	float time{ 0 };
+	float loudness{ 0 };
+	float beatPhase{ 1.0f };
+	float padding{ 0 };
+};
+
+class FrameUniforms
+{
+public:
+	bool Init();
+	void Release();
+
+	// The camera only changes with the window
+	void SetCamera(const glm::mat4& view,const glm::mat4& projection);
+	// Once per frame, before anything draws
+	void Update(double time,float loudness);
+
+	const FrameBlock& GetBlock() const
+	{
+		return m_Block;
+	}
+
+	// Points a program's Frame block, if it has one, at the shared buffer.
+	// LoadShaders does this for every program it links.
+	static void Attach(GLuint program);
+
+private:
+	GLuint m_Buffer{ 0 };
+	FrameBlock m_Block;
+	// Running loudness average the beats stand out from
+	float m_AverageLoudness{ 0 };
+	double m_LastBeat{ -1.0 };
+	double m_BeatInterval{ 0.5 };
+};
@@ -0,0 +1,121 @@
+#include "IndexTopology.h"
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+typedef std::tuple<int,int,int> TopologyKey;
+
+// Only the render thread draws, so the cache needs no lock
+static std::map<TopologyKey,std::unique_ptr<IndexTopology>>& GetTopologies()
+{
+	static std::map<TopologyKey,std::unique_ptr<IndexTopology>> topologies;
+	return topologies;
+}
+
+template<typename Index>
+static std::vector<Index> BuildIndices(TopologyKind kind,int rows,int columns)
+{
+	std::vector<Index> indices;
+	if(kind==TOPOLOGY_GRID_STRIP)
+	{
+		indices.reserve((size_t)rows*(2*columns+3));
+		for(int i = 0; i<rows; ++i)
+		{
+			if(i>0)
+			{
+				indices.push_back((Index)-1);
+			}
+			for(int j = 0; j<=columns; ++j)
+			{
+				Index a = (Index)(i*(columns+1)+j);
+				indices.push_back(a);
+				indices.push_back((Index)(a+columns+1));
+			}
+		}
+		return indices;
+	}
+	indices.reserve((size_t)rows*columns*6);
+	for(int i = 0; i<rows; ++i)
+	{
+		for(int j = 0; j<columns; ++j)
+		{
+			Index a = (Index)(i*(columns+1)+j);
+			Index b = (Index)(a+columns+1);
+			indices.insert(indices.end(),{ a,b,(Index)(a+1),b,(Index)(b+1),(Index)(a+1) });
+		}
+	}
+	return indices;
+}
+
+template<typename Index>
+static GLsizei Upload(TopologyKind kind,int rows,int columns)
+{
+	std::vector<Index> indices = BuildIndices<Index>(kind,rows,columns);
+	glBufferData(GL_COPY_WRITE_BUFFER,indices.size()*sizeof(Index),indices.data(),GL_STATIC_DRAW);
+	return (GLsizei)indices.size();
+}
+
+IndexTopology::IndexTopology(TopologyKind kind,int rows,int columns)
+{
+	glGenBuffers(1,&m_Buffer);
+	// Not GL_ELEMENT_ARRAY_BUFFER, which would attach it to the bound VAO
+	glBindBuffer(GL_COPY_WRITE_BUFFER,m_Buffer);
+	m_Mode = kind==TOPOLOGY_GRID_STRIP ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+	// The largest index of the type is kept for primitive restart
+	size_t vertexCount = (size_t)(rows+1)*(columns+1);
+	if(vertexCount<0xFFFF)
+	{
+		m_Type = GL_UNSIGNED_SHORT;
+		m_Count = Upload<uint16_t>(kind,rows,columns);
+	}
+	else
+	{
+		m_Type = GL_UNSIGNED_INT;
+		m_Count = Upload<uint32_t>(kind,rows,columns);
+	}
+}
+
+IndexTopology::~IndexTopology()
+{
+	if(m_Buffer)
+	{
+		glDeleteBuffers(1,&m_Buffer);
+	}
+}
+
+const IndexTopology& IndexTopology::Get(TopologyKind kind,int rows,int columns)
+{
+	std::unique_ptr<IndexTopology>& topology = GetTopologies()[TopologyKey(kind,rows,columns)];
+	if(!topology)
+	{
+		topology.reset(new IndexTopology(kind,rows,columns));
+	}
+	return *topology;
+}
+
+void IndexTopology::ReleaseAll()
+{
+	GetTopologies().clear();
+}
+
+void IndexTopology::Bind() const
+{
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m_Buffer);
+}
+
+void IndexTopology::Draw(GLint baseVertex) const
+{
+	bool restart = m_Mode==GL_TRIANGLE_STRIP;
+	if(restart)
+	{
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(m_Type==GL_UNSIGNED_SHORT ? 0xFFFF : 0xFFFFFFFF);
+	}
+	glDrawElementsBaseVertex(m_Mode,m_Count,m_Type,(void*)0,baseVertex);
+	if(restart)
+	{
+		glDisable(GL_PRIMITIVE_RESTART);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "GL/glew.h"
+
+#include <stdint.h>
+
+// How a grid of rows x columns quads over (rows+1) x (columns+1)
+// vertices, laid out row by row, is cut into triangles. With a the
+// corner of a cell and b the one below it:
+enum TopologyKind
+{
+	// Triangles (a, b, a+1) (b, b+1, a+1), six indices a cell
+	TOPOLOGY_GRID = 0,
+	// The same cells as one triangle strip a row, a0 b0 a1 b1 ...,
+	// with a restart index between rows: about two indices a cell
+	TOPOLOGY_GRID_STRIP = 1,
+};
+
+//==============================================================
+// Index buffers that depend only on a shape's resolution. Each is
+// built on first use, kept on the GPU and shared by every shape
+// asking for the same (kind, rows, columns), so no frame builds
+// or uploads indices. Indices are 16 bit when the vertices allow.
+//==============================================================
+class IndexTopology
+{
+public:
+	// Needs the GL context; the first call for a key uploads its buffer
+	static const IndexTopology& Get(TopologyKind kind,int rows,int columns);
+	// Deletes every buffer; needs the GL context
+	static void ReleaseAll();
+
+	GLuint GetBuffer() const
+	{
+		return m_Buffer;
+	}
+
+	GLsizei GetCount() const
+	{
+		return m_Count;
+	}
+
+	// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	GLenum GetType() const
+	{
+		return m_Type;
+	}
+
+	// GL_TRIANGLES or GL_TRIANGLE_STRIP
+	GLenum GetMode() const
+	{
+		return m_Mode;
+	}
+
+	// Binds the buffer to GL_ELEMENT_ARRAY_BUFFER, so to the bound VAO
+	void Bind() const;
+	// Draws the whole topology from the bound VAO, which must have this
+	// buffer bound. Strips turn primitive restart on for the draw only.
+	void Draw(GLint baseVertex = 0) const;
+
+	IndexTopology(TopologyKind kind,int rows,int columns);
+	~IndexTopology();
+
+private:
+	IndexTopology(const IndexTopology&) = delete;
+	IndexTopology& operator=(const IndexTopology&) = delete;
+
+	GLuint m_Buffer{ 0 };
+	GLsizei m_Count{ 0 };
+	GLenum m_Type{ GL_UNSIGNED_INT };
+	GLenum m_Mode{ GL_TRIANGLES };
+};
@@ -7,6 +7,7 @@
 
 #include "AudioVis.h"
 #include "DrawBase.h"
+#include "SpectrumTexture.h"
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
@@ -28,10 +29,16 @@ public:
 
 	virtual void Draw(Visualizer* visualizer)override;
 
-private:
-	unsigned int GenVAO(const std::vector<float>& heigthlist);
-	std::vector<glm::vec3> GetVetexData(const std::vector<float>& heigthlist);
+	virtual void Release()override;
+
 private:
 	GLuint shader;
-	GLuint MVPID;
+	GLuint m_FirstID;
+	// Set on each draw: the program is shared by source with other shapes
+	GLint m_ModelID{ -1 };
+	GLint m_SegmentID{ -1 };
+	GLint m_ColorID{ -1 };
+	glm::mat4 m_Model{ 1.0f };
+	// The area is built in Shaders/LineArea.vs from the heights alone
+	SpectrumTexture m_Heights;
 };
@@ -7,11 +7,15 @@
 
 #include "AudioVis.h"
 #include "DrawBase.h"
+#include "BarRenderer.h"
+#include "IndexTopology.h"
+#include "VertexFormat.h"
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"	
 #include "glm/gtx/transform.hpp"	
+#include <random>
 
 class AudioObject;
 class Visualizer;
@@ -36,23 +40,27 @@ public:
 	virtual void Draw(Visualizer* visualizer)override;
 
 	void DrawRect(Visualizer* visualizer);
+
+	virtual void Release()override;
 private:
-	unsigned int GenVAO(const std::vector<float>& heigthlist);
-	unsigned int GenRectVAO(const std::vector<float>& heigthlist);
-	void GenerateNoisySphere(const std::vector<float>& heigthlist,int stacks,int slices);
-	std::vector<glm::vec3> GetRectVetexData(const std::vector<float>& heigthlist);
+	// The unit sphere, built once; the audio only moves uniforms
+	bool GenerateSphere(int stacks,int slices);
 	unsigned int loadTexture(char const* path,bool gammaCorrection);
 private:
 	GLuint shader;
-	GLuint rectshader;
-	GLuint MVPID;
-	GLuint rectMVPID;
-	GLuint uNoiseScaleID;
-	GLuint uNoiseStrengthID;
+	GLuint uColorID;
+	// Set on each draw: the program is shared by source with other shapes
+	GLint m_ModelID{ -1 };
+	GLint m_RadiusID{ -1 };
+	glm::mat4 m_Model{ 1.0f };
 	float m_fSphereRadius = 1;
 	int m_SphereRow = 61;
 	int m_SphereCol = 60;
-	std::vector<glm::vec3> vertices;
-	std::vector<unsigned int> indices;
 	unsigned int woodTexture=0;
+	GLuint m_VAO{ 0 };
+	GLuint m_VertexBuffer{ 0 };
+	// Flickers the tint each frame, seeded once in Init
+	std::mt19937 m_ColorGen;
+	BarRenderer m_Bars;
+	BarStyle m_BarStyle;
 };
@@ -0,0 +1,380 @@
+#include "Playlist.h"
+
+Playlist::Playlist(const std::vector<std::string>& paths,bool loop)
+	: m_Paths(paths),m_Loop(loop)
+{
+}
+
+Playlist::~Playlist()
+{
+	Stop();
+}
+
+bool Playlist::Start()
+{
+	m_Current = m_Paths.empty() ? nullptr : LoadPlayable(0);
+	if(!m_Current)
+	{
+		std::cout<<"Playlist has no playable tracks"<<std::endl;
+		return false;
+	}
+	m_CurrentOffset = 0;
+	m_Fed = 0;
+	m_Chunk.resize(PLAYLIST_CHUNK_FRAMES*m_Current->channelCount);
+	{
+		std::lock_guard<std::mutex> lock(m_BoundaryMutex);
+		m_Boundaries.clear();
+		m_Boundaries.push_back({ 0,m_Current });
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = false;
+		m_NextIndex = NextIndex(m_Current->index);
+	}
+	m_Worker = std::thread(&Playlist::PrefetchLoop,this);
+	initialize(m_Current->channelCount,m_Current->sampleRate);
+	play();
+	return true;
+}
+
+void Playlist::Stop()
+{
+	// Release the stream thread first in case it is waiting on the worker
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+	}
+	m_Wake.notify_all();
+	stop();
+	if(m_Worker.joinable())
+	{
+		m_Worker.join();
+	}
+}
+
+bool Playlist::IsPlaying() const
+{
+	return getStatus()!=sf::SoundSource::Stopped||m_FormatChange;
+}
+
+void Playlist::Update()
+{
+	if(m_FormatChange&&getStatus()==sf::SoundSource::Stopped)
+	{
+		// The stream drained the previous track; reopen it in the new format
+		std::shared_ptr<PlaylistTrack> next;
+		if(TakeNext(next,true))
+		{
+			Retire(m_Current);
+			m_Current = next;
+			m_CurrentOffset = 0;
+			m_Fed = 0;
+			m_Chunk.resize(PLAYLIST_CHUNK_FRAMES*m_Current->channelCount);
+			{
+				std::lock_guard<std::mutex> lock(m_BoundaryMutex);
+				for(auto& boundary:m_Boundaries)
+				{
+					Retire(boundary.track);
+				}
+				m_Boundaries.clear();
+				m_Boundaries.push_back({ 0,m_Current });
+			}
+			{
+				// onGetData queues the following track after a join; do the same here
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_NextIndex = NextIndex(m_Current->index);
+			}
+			m_Wake.notify_all();
+			initialize(m_Current->channelCount,m_Current->sampleRate);
+			m_FormatChange = false;
+			play();
+		}
+		else
+		{
+			m_FormatChange = false;
+		}
+	}
+}
+
+int Playlist::GetCurrentTrackIndex() const
+{
+	std::lock_guard<std::mutex> lock(m_BoundaryMutex);
+	return m_Boundaries.empty() ? -1 : m_Boundaries.front().track->index;
+}
+
+unsigned long long Playlist::GetDataPosition() const
+{
+	unsigned long long position = GetStreamPosition();
+	std::lock_guard<std::mutex> lock(m_BoundaryMutex);
+	unsigned long long local = 0;
+	const Boundary* boundary = FindBoundary(position,local);
+	if(!boundary)
+	{
+		return position;
+	}
+	const PlaylistTrack& track = *boundary->track;
+	double seconds = (double)(local/track.channelCount)/track.sampleRate;
+	int frame = track.spectrum.FrameAtTime(seconds);
+	if(frame<0)
+	{
+		// No spectrum: step at the rate one would have had
+		frame = (int)(seconds*SPECTRUM_FRAME_RATE);
+	}
+	// A track holds more samples than frames, so keys can't overlap the next one
+	return boundary->streamSample+(unsigned long long)frame;
+}
+
+double Playlist::GetPlayingTime() const
+{
+	unsigned long long position = GetStreamPosition();
+	std::lock_guard<std::mutex> lock(m_BoundaryMutex);
+	unsigned long long local = 0;
+	const Boundary* boundary = FindBoundary(position,local);
+	if(!boundary)
+	{
+		return 0;
+	}
+	return (double)(local/boundary->track->channelCount)/boundary->track->sampleRate;
+}
+
+unsigned long long Playlist::GetStreamPosition() const
+{
+	return (unsigned long long)(getPlayingOffset().asSeconds()*getSampleRate())*getChannelCount();
+}
+
+const Playlist::Boundary* Playlist::FindBoundary(unsigned long long position,unsigned long long& local) const
+{
+	const Boundary* found = nullptr;
+	for(const Boundary& boundary:m_Boundaries)
+	{
+		if(found&&boundary.streamSample>position)
+		{
+			break;
+		}
+		found = &boundary;
+	}
+	if(found)
+	{
+		local = position>found->streamSample ? position-found->streamSample : 0;
+	}
+	return found;
+}
+
+const float* Playlist::GetCurrentSpectrum(int* binCount)
+{
+	unsigned long long position = GetStreamPosition();
+	std::lock_guard<std::mutex> lock(m_BoundaryMutex);
+	// Drop tracks the listener has fully moved past; the worker frees them
+	while(m_Boundaries.size()>1&&m_Boundaries[1].streamSample<=position)
+	{
+		Retire(m_Boundaries.front().track);
+		m_Boundaries.pop_front();
+	}
+	if(m_Boundaries.empty())
+	{
+		return nullptr;
+	}
+	const Boundary& boundary = m_Boundaries.front();
+	const PlaylistTrack& track = *boundary.track;
+	const SpectrumFile& spectrum = track.spectrum;
+	unsigned long long local = position>boundary.streamSample ? position-boundary.streamSample : 0;
+	int frame = spectrum.FrameAtTime((double)(local/track.channelCount)/track.sampleRate);
+	if(frame<0)
+	{
+		return nullptr;
+	}
+	if(binCount)
+	{
+		*binCount = spectrum.GetBinCount();
+	}
+	return spectrum.GetFrame(frame);
+}
+
+bool Playlist::onGetData(Chunk& data)
+{
+	size_t filled = 0;
+	while(filled<m_Chunk.size())
+	{
+		size_t remaining = m_Current->samples.size()-m_CurrentOffset;
+		if(remaining==0)
+		{
+			std::shared_ptr<PlaylistTrack> next;
+			bool pending = false;
+			if(!TakeNext(next,false,&pending))
+			{
+				if(!pending)
+				{
+					break;
+				}
+				// Never wait on the decoder from the audio thread: play silence
+				// until the next track is ready
+				std::fill(m_Chunk.begin()+filled,m_Chunk.end(),(sf::Int16)0);
+				filled = m_Chunk.size();
+				break;
+			}
+			if(next->channelCount!=m_Current->channelCount||next->sampleRate!=m_Current->sampleRate)
+			{
+				// Can't splice different formats into one stream: hand it back for Update()
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Next = next;
+				m_FormatChange = true;
+				break;
+			}
+			Retire(m_Current);
+			m_Current = next;
+			m_CurrentOffset = 0;
+			{
+				std::lock_guard<std::mutex> lock(m_BoundaryMutex);
+				m_Boundaries.push_back({ m_Fed+filled,m_Current });
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_NextIndex = NextIndex(m_Current->index);
+			}
+			m_Wake.notify_all();
+			continue;
+		}
+		size_t count = std::min(remaining,m_Chunk.size()-filled);
+		std::copy(m_Current->samples.begin()+m_CurrentOffset,m_Current->samples.begin()+m_CurrentOffset+count,m_Chunk.begin()+filled);
+		m_CurrentOffset += count;
+		filled += count;
+	}
+	m_Fed += filled;
+	data.samples = m_Chunk.data();
+	data.sampleCount = filled;
+	return filled==m_Chunk.size();
+}
+
+void Playlist::onSeek(sf::Time timeOffset)
+{
+	if(!m_Current)
+	{
+		return;
+	}
+	// Seeking stays within the current track
+	size_t offset = (size_t)(timeOffset.asSeconds()*m_Current->sampleRate)*m_Current->channelCount;
+	m_CurrentOffset = std::min(offset,m_Current->samples.size());
+	m_Fed = m_CurrentOffset;
+	std::lock_guard<std::mutex> lock(m_BoundaryMutex);
+	m_Boundaries.clear();
+	m_Boundaries.push_back({ 0,m_Current });
+}
+
+std::shared_ptr<PlaylistTrack> Playlist::LoadPlayable(int index)
+{
+	// Skip over entries that fail to decode, trying each at most once
+	for(size_t attempt = 0; attempt<m_Paths.size()&&index>=0; ++attempt)
+	{
+		std::shared_ptr<PlaylistTrack> track = LoadTrack(index);
+		if(track)
+		{
+			return track;
+		}
+		index = NextIndex(index);
+	}
+	return nullptr;
+}
+
+std::shared_ptr<PlaylistTrack> Playlist::LoadTrack(int index)
+{
+	sf::InputSoundFile file;
+	if(!file.openFromFile(m_Paths[index]))
+	{
+		std::cout<<"Unable to open playlist entry "<<m_Paths[index]<<std::endl;
+		return nullptr;
+	}
+	std::shared_ptr<PlaylistTrack> track = std::make_shared<PlaylistTrack>();
+	track->index = index;
+	track->path = m_Paths[index];
+	track->sampleRate = file.getSampleRate();
+	track->channelCount = file.getChannelCount();
+	track->samples.resize((size_t)file.getSampleCount());
+	track->samples.resize((size_t)file.read(track->samples.data(),track->samples.size()));
+
+	std::vector<sf::Int16> mono;
+	size_t frames = track->samples.size()/track->channelCount;
+	AudioAnalyzer::Downmix(track->samples.data(),frames,track->channelCount,mono);
+	// Same key as single-file mode, so a track analysed by either is mapped by both
+	if(!SpectrumCache().Load(mono.data(),mono.size(),track->sampleRate,track->spectrum))
+	{
+		std::cout<<"Unable to analyse "<<track->path<<std::endl;
+	}
+	return track;
+}
+
+int Playlist::NextIndex(int index) const
+{
+	if(index+1<(int)m_Paths.size())
+	{
+		return index+1;
+	}
+	return m_Loop&&!m_Paths.empty() ? 0 : -1;
+}
+
+void Playlist::PrefetchLoop()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while(!m_Quit)
+	{
+		m_Wake.wait(lock,[this]
+		{
+			return m_Quit||!m_Retired.empty()||(!m_Next&&m_NextIndex>=0);
+		});
+		if(m_Quit)
+		{
+			break;
+		}
+		// Free finished tracks here rather than on the audio or render thread
+		std::vector<std::shared_ptr<PlaylistTrack>> retired;
+		retired.swap(m_Retired);
+		int requested = m_Next ? -1 : m_NextIndex;
+		lock.unlock();
+		retired.clear();
+		std::shared_ptr<PlaylistTrack> next;
+		if(requested>=0)
+		{
+			next = LoadPlayable(requested);
+		}
+		lock.lock();
+		if(requested>=0&&m_NextIndex==requested)
+		{
+			m_Next = next;
+			m_NextIndex = -1;
+			m_Wake.notify_all();
+		}
+	}
+}
+
+bool Playlist::TakeNext(std::shared_ptr<PlaylistTrack>& next,bool wait,bool* pending)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	if(wait)
+	{
+		// Only blocks if the worker hasn't finished decoding yet
+		m_Wake.wait(lock,[this]
+		{
+			return m_Quit||m_Next||m_NextIndex<0;
+		});
+	}
+	next = m_Next;
+	m_Next = nullptr;
+	if(pending)
+	{
+		*pending = !next&&!m_Quit&&m_NextIndex>=0;
+	}
+	return next!=nullptr;
+}
+
+void Playlist::Retire(std::shared_ptr<PlaylistTrack>& track)
+{
+	if(!track)
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Retired.push_back(track);
+	}
+	track = nullptr;
+	m_Wake.notify_all();
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "SpectrumCache.h"
+#include "SFML/Audio.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//==============================================================
+// A decoded, pre-analysed track ready to be streamed
+//==============================================================
+struct PlaylistTrack
+{
+	int index{ -1 };
+	std::string path;
+	unsigned int sampleRate{ 0 };
+	unsigned int channelCount{ 0 };
+	std::vector<sf::Int16> samples;	// interleaved, as decoded
+	SpectrumFile spectrum;			// mapped from the spectrum cache; closed if analysis failed
+};
+
+//==============================================================
+// Plays a list of files back to back through one sound stream.
+// While a track plays, a worker thread decodes and analyses the
+// next one, so the switch happens inside the audio callback with
+// no gap and nothing left to do on the render thread. The audio
+// callback never waits for the worker: if a track is still being
+// decoded when the last one ends, it plays silence until it is ready.
+//==============================================================
+class Playlist:private sf::SoundStream
+{
+public:
+	explicit Playlist(const std::vector<std::string>& paths,bool loop = false);
+	~Playlist();
+
+	// Decodes the first track synchronously and starts playback
+	bool Start();
+	void Stop();
+	bool IsPlaying() const;
+
+	// Call once per frame: restarts the stream if the next track has a
+	// different format and so could not be joined gaplessly
+	void Update();
+
+	// Changes when the audible spectrum frame does, and never repeats
+	// across tracks: the track's start in the stream plus its frame index
+	unsigned long long GetDataPosition() const;
+	// Seconds into the track audible right now
+	double GetPlayingTime() const;
+
+	// Track audible right now and the spectrum frame for the current position
+	int GetCurrentTrackIndex() const;
+	const float* GetCurrentSpectrum(int* binCount = nullptr);
+
+private:
+	struct Boundary
+	{
+		unsigned long long streamSample;	// interleaved samples fed before this track
+		std::shared_ptr<PlaylistTrack> track;
+	};
+
+	virtual bool onGetData(Chunk& data)override;
+	virtual void onSeek(sf::Time timeOffset)override;
+
+	// Interleaved samples played so far
+	unsigned long long GetStreamPosition() const;
+	// Last boundary playback has reached, whether or not it has been
+	// retired yet; local receives the offset into it. Needs m_BoundaryMutex.
+	const Boundary* FindBoundary(unsigned long long position,unsigned long long& local) const;
+
+	std::shared_ptr<PlaylistTrack> LoadTrack(int index);
+	std::shared_ptr<PlaylistTrack> LoadPlayable(int index);
+	int NextIndex(int index) const;
+	void PrefetchLoop();
+	// Without wait, pending says whether a track is still being decoded
+	bool TakeNext(std::shared_ptr<PlaylistTrack>& next,bool wait,bool* pending = nullptr);
+	void Retire(std::shared_ptr<PlaylistTrack>& track);
+
+	std::vector<std::string> m_Paths;
+	bool m_Loop;
+
+	// Owned by the stream thread
+	std::shared_ptr<PlaylistTrack> m_Current;
+	size_t m_CurrentOffset{ 0 };
+	unsigned long long m_Fed{ 0 };
+	std::vector<sf::Int16> m_Chunk;
+
+	// Shared with the prefetch worker
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::shared_ptr<PlaylistTrack> m_Next;
+	int m_NextIndex{ -1 };
+	std::vector<std::shared_ptr<PlaylistTrack>> m_Retired;
+	bool m_Quit{ false };
+	std::thread m_Worker;
+
+	// Shared with the render thread
+	mutable std::mutex m_BoundaryMutex;
+	std::deque<Boundary> m_Boundaries;
+	std::atomic<bool> m_FormatChange{ false };
+};
@@ -0,0 +1,77 @@
+#include "PolarBasis.h"
+
+#include <cmath>
+#include <map>
+#include <memory>
+
+// Only the render thread draws, so the tables need no lock
+static std::map<int,std::unique_ptr<PolarBasis>>& GetTables()
+{
+	static std::map<int,std::unique_ptr<PolarBasis>> tables;
+	return tables;
+}
+
+PolarBasis::PolarBasis(int segments)
+	: m_Basis(segments+1)
+{
+	// In double, so the last entry lands back on (1, 0)
+	for(int i = 0; i<=segments; ++i)
+	{
+		double angle = 2.0*M_PI*i/segments;
+		m_Basis[i] = glm::vec2((float)cos(angle),(float)sin(angle));
+	}
+}
+
+const PolarBasis& PolarBasis::Get(int segments)
+{
+	segments = std::max(segments,1);
+	std::unique_ptr<PolarBasis>& table = GetTables()[segments];
+	if(!table)
+	{
+		table.reset(new PolarBasis(segments));
+	}
+	return *table;
+}
+
+void PolarBasis::ReleaseAll()
+{
+	for(auto& table:GetTables())
+	{
+		table.second->Release();
+	}
+}
+
+GLuint PolarBasis::GetTexture() const
+{
+	if(!m_Texture)
+	{
+		glGenBuffers(1,&m_Buffer);
+		glBindBuffer(GL_TEXTURE_BUFFER,m_Buffer);
+		glBufferData(GL_TEXTURE_BUFFER,m_Basis.size()*sizeof(glm::vec2),m_Basis.data(),GL_STATIC_DRAW);
+		glGenTextures(1,&m_Texture);
+		glBindTexture(GL_TEXTURE_BUFFER,m_Texture);
+		glTexBuffer(GL_TEXTURE_BUFFER,GL_RG32F,m_Buffer);
+	}
+	return m_Texture;
+}
+
+void PolarBasis::Bind(int unit) const
+{
+	GLuint texture = GetTexture();
+	glActiveTexture(GL_TEXTURE0+unit);
+	glBindTexture(GL_TEXTURE_BUFFER,texture);
+}
+
+void PolarBasis::Release() const
+{
+	if(m_Texture)
+	{
+		glDeleteTextures(1,&m_Texture);
+		m_Texture = 0;
+	}
+	if(m_Buffer)
+	{
+		glDeleteBuffers(1,&m_Buffer);
+		m_Buffer = 0;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+#include "AudioVis.h"
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+#include <vector>
+
+//==============================================================
+// The unit vectors (cos, sin) of angle i*2pi/segments for i in
+// [0,segments], worked out once per segment count and shared by
+// every mode that lays things out round a circle. A point at
+// radius r is r*basis, its tangent (-sin, cos).
+//
+// Vertex shaders read the same table from a GL_RG32F buffer
+// texture instead of calling cos and sin per vertex:
+//
+//   uniform samplerBuffer uBasis;   texelFetch(uBasis, i).xy
+//
+// SpectrumTexture keeps unit 0, so the shapes bind this to unit 1.
+//==============================================================
+class PolarBasis
+{
+public:
+	// Built on first use and kept until ReleaseAll
+	static const PolarBasis& Get(int segments);
+	// Drops the textures of every table; needs the GL context
+	static void ReleaseAll();
+
+	int GetSegments() const
+	{
+		return (int)m_Basis.size()-1;
+	}
+
+	const glm::vec2& operator[](int index) const
+	{
+		return m_Basis[index];
+	}
+
+	// Made the first time it is asked for
+	GLuint GetTexture() const;
+	// Binds the texture to texture unit `unit`
+	void Bind(int unit) const;
+
+private:
+	explicit PolarBasis(int segments);
+	void Release() const;
+
+	std::vector<glm::vec2> m_Basis;
+	mutable GLuint m_Buffer{ 0 };
+	mutable GLuint m_Texture{ 0 };
+};
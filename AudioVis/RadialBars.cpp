@@ -0,0 +1,37 @@
+#include "RadialBars.h"
+#include "Shader.hpp"
+
+bool RadialBarProgram::Init()
+{
+	m_Program = LoadShaders("Shaders/RadialBars.vs","Shaders/AudioRect.fs");
+	if(m_Program==0)
+	{
+		return false;
+	}
+	m_ModelID = glGetUniformLocation(m_Program,"uModel");
+	m_BasisID = glGetUniformLocation(m_Program,"uBasis");
+	m_FirstID = glGetUniformLocation(m_Program,"uFirst");
+	m_CountID = glGetUniformLocation(m_Program,"uCount");
+	m_BaseRadiusID = glGetUniformLocation(m_Program,"uBaseRadius");
+	m_InnerID = glGetUniformLocation(m_Program,"uInner");
+	m_OuterID = glGetUniformLocation(m_Program,"uOuter");
+	m_MinLengthID = glGetUniformLocation(m_Program,"uMinLength");
+	m_HalfWidthID = glGetUniformLocation(m_Program,"uHalfWidth");
+	m_ColorID = glGetUniformLocation(m_Program,"uColor");
+	return true;
+}
+
+void RadialBarProgram::Use(const glm::mat4& model,const RadialBarStyle& style,GLint first,GLint count) const
+{
+	glUseProgram(m_Program);
+	glUniformMatrix4fv(m_ModelID,1,GL_FALSE,&model[0][0]);
+	glUniform1i(m_BasisID,1);
+	glUniform1i(m_FirstID,first);
+	glUniform1i(m_CountID,count);
+	glUniform1f(m_BaseRadiusID,style.baseRadius);
+	glUniform1f(m_InnerID,style.inner);
+	glUniform1f(m_OuterID,style.outer);
+	glUniform1f(m_MinLengthID,style.minLength);
+	glUniform1f(m_HalfWidthID,style.halfWidth);
+	glUniform3fv(m_ColorID,1,&style.color[0]);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+//==============================================================
+// Spokes round a circle as Shaders/RadialBars.vs draws them: bar i
+// spans radius baseRadius-inner*len to baseRadius+outer*len, where
+// len is its height raised to at least minLength.
+//==============================================================
+struct RadialBarStyle
+{
+	float baseRadius{ 1.0f };
+	float inner{ 0.0f };
+	float outer{ 1.0f };
+	float minLength{ 0.0f };
+	float halfWidth{ 0.02f };
+	glm::vec3 color{ 1.0f,1.0f,1.0f };
+};
+
+//==============================================================
+// The RadialBars.vs program and its uniform locations. LoadShaders
+// hands every shape the same program for the same sources, so the
+// model and style go in on each Use, not once at Init.
+//==============================================================
+class RadialBarProgram
+{
+public:
+	bool Init();
+
+	// Makes the program current with this shape's placement and the
+	// frame's heights at first..first+count; the basis goes on unit 1
+	void Use(const glm::mat4& model,const RadialBarStyle& style,GLint first,GLint count) const;
+
+private:
+	GLuint m_Program{ 0 };
+	GLint m_ModelID{ -1 };
+	GLint m_BasisID{ -1 };
+	GLint m_FirstID{ -1 };
+	GLint m_CountID{ -1 };
+	GLint m_BaseRadiusID{ -1 };
+	GLint m_InnerID{ -1 };
+	GLint m_OuterID{ -1 };
+	GLint m_MinLengthID{ -1 };
+	GLint m_HalfWidthID{ -1 };
+	GLint m_ColorID{ -1 };
+};
@@ -20,17 +20,37 @@ RingRectShape::~RingRectShape()
 
 bool RingRectShape::Init()
 {
+	// The programs are shared with other shapes, so the model is set per draw
+	m_Model = glm::translate(glm::mat4(1.0f),glm::vec3(0,0,-10));
 	shader = LoadShaders("Shaders/AudioRect.vs","Shaders/AudioRect.fs");
 	if(shader>0)
 	{
-		MVPID = glGetUniformLocation(shader,"MVP");
+		m_ModelID = glGetUniformLocation(shader,"uModel");
 	}
-	return true;
+	// Bars centred on a circle of radius 3, reaching height both ways
+	m_BarStyle.baseRadius = 3.0f;
+	m_BarStyle.inner = 1.0f;
+	m_BarStyle.outer = 1.0f;
+	m_BarStyle.minLength = 0.05f;
+	m_BarStyle.halfWidth = 0.02f;
+	m_BarStyle.color = glm::vec3(254.0/255.0,164/255.0,67/255.0);
+	return m_Bars.Init()&&GenVAO()&&m_Heights.Init();
+}
+
+void RingRectShape::Release()
+{
+	if(m_VAO)
+	{
+		glDeleteVertexArrays(1,&m_VAO);
+		m_VAO = 0;
+	}
+	m_VertexBuffer.Release();
+	m_Heights.Release();
 }
 
 void RingRectShape::Draw(Visualizer* visualizer)
 {
-	auto heightlist = visualizer->GetHeightList(m_Framecount%m_TotalNum);
+	auto heightlist = visualizer->GetHeightList(visualizer->GetCurrentFrame());
 	int averageNum = 2;
 	vector<float> templist;
 	for(int i = averageNum; i<heightlist.size(); i++)
@@ -43,117 +63,43 @@ void RingRectShape::Draw(Visualizer* visualizer)
 		temp /= (averageNum+1);
 		templist.push_back(temp);
 	}
-	auto particlevao = GenParticleVAO();
-	auto vao = GenVAO(templist);
-	glm::mat4 Projection = glm::perspective(glm::radians(60.0f),1280.0f/720.0f,0.1f,1000.0f);
-	glm::mat4 View = glm::lookAt(
-		glm::vec3(0,0,0),
-		glm::vec3(0,0,-1),
-		glm::vec3(0,1,0)
-	);
-	glm::mat4 Model = glm::mat4(1.0f);
-	Model = glm::translate(Model,glm::vec3(0,0,-10));
-	glm::mat4 MVP = Projection*View*Model;
+	GetParticleVertexData();
 	glClearColor(0.3,0.3,0.3,1.0);
 	glUseProgram(shader);
-	glUniformMatrix4fv(MVPID,1,GL_FALSE,&MVP[0][0]);
-
-	glBindVertexArray(particlevao);
-	glDrawArrays(GL_TRIANGLES,0,m_ParticleVertex.size()*6);
+	glUniformMatrix4fv(m_ModelID,1,GL_FALSE,&m_Model[0][0]);
 
-	glBindVertexArray(vao);
-	glDrawArrays(GL_TRIANGLES,0,heightlist.size()*6);
-
-	glDeleteVertexArrays(1,&particlevao);
-	glDeleteVertexArrays(1,&vao);
-	m_Framecount++;
-}
-
-unsigned int RingRectShape::GenVAO(const std::vector<float>& heigthlist)
-{
-	unsigned int VBO,VAO;
-	glGenVertexArrays(1,&VAO);
-	glGenBuffers(1,&VBO);
-	glBindVertexArray(VAO);
-
-	GetVetexData(heigthlist);
-	glBindBuffer(GL_ARRAY_BUFFER,VBO);
-	glBufferData(GL_ARRAY_BUFFER,sizeof(glm::vec3)*m_Vertexdata.size(),&m_Vertexdata[0],GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,6*sizeof(float),(void*)0);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,6*sizeof(float),(void*)(3*sizeof(float)));
-	glEnableVertexAttribArray(1);
+	glBindVertexArray(m_VAO);
+	GLint first = m_VertexBuffer.Upload(m_ParticleVertex.data(),m_ParticleVertex.size(),sizeof(ColorVertex));
+	if(first>=0)
+	{
+		glDrawArrays(GL_TRIANGLES,first,m_ParticleVertex.size());
+	}
+	m_VertexBuffer.EndFrame();
 
-	return VAO;
+	// Bars for the first 80% of the smoothed heights, spread round the circle
+	first = m_Heights.Upload(templist);
+	if(first<0)
+	{
+		return;
+	}
+	GLint num = templist.size()*0.8;
+	m_Bars.Use(m_Model,m_BarStyle,first,num);
+	PolarBasis::Get(num).Bind(1);
+	m_Heights.Draw(GL_TRIANGLE_STRIP,4,num);
 }
 
-unsigned int RingRectShape::GenParticleVAO()
-{
-	unsigned int VBO,VAO;
-	glGenVertexArrays(1,&VAO);
-	glGenBuffers(1,&VBO);
-	glBindVertexArray(VAO);
-
-	GetParticleVertexData();
-	glBindBuffer(GL_ARRAY_BUFFER,VBO);
-	glBufferData(GL_ARRAY_BUFFER,sizeof(glm::vec3)*m_ParticleVertex.size(),&m_ParticleVertex[0],GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,6*sizeof(float),(void*)0);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,6*sizeof(float),(void*)(3*sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	return VAO;
-}
-void RingRectShape::GetVetexData(const std::vector<float>& heigthlist)
+bool RingRectShape::GenVAO()
 {
-	m_Vertexdata.clear();
-	int num = heigthlist.size()*0.8;
-	float row_delta = -glm::radians(360.0f)/num;
-	float delta = 0.02;
-	glm::vec3 color = { 254.0/255.0,164/255.0,67/255.0 };
-	for(int i = 0; i<num; i++)
+	if(!m_VertexBuffer.Init())
 	{
-		float m_fRadius = 3.0;
-		auto cosV = glm::cos(i*row_delta);
-		auto sinV = glm::sin(i*row_delta);
-		float len = heigthlist[i];
-		if(len<0.05)
-		{
-			len = 0.05;
-		}
-		glm::vec3 positionW = glm::vec3((m_fRadius+len)*cosV,(m_fRadius+len)*sinV,0.0f);
-		glm::vec3 positionN = glm::vec3((m_fRadius-len)*cosV,(m_fRadius-len)*sinV,0.0f);
-		glm::vec3 qieLine = { -positionN.y,positionN.x,0.0 };
-		glm::vec3 norqeiline = glm::normalize(qieLine);
-		glm::vec3 p0 = positionN-norqeiline*delta;
-		glm::vec3 p1 = positionN+norqeiline*delta;
-		glm::vec3 p2 = positionW+norqeiline*delta;
-		glm::vec3 p3 = positionW-norqeiline*delta;
-
-		m_Vertexdata.push_back(p0);
-		m_Vertexdata.push_back(color);
-
-		m_Vertexdata.push_back(p1);
-		m_Vertexdata.push_back(color);
-
-		m_Vertexdata.push_back(p2);
-		m_Vertexdata.push_back(color);
-
-		m_Vertexdata.push_back(p2);
-		m_Vertexdata.push_back(color);
-
-		m_Vertexdata.push_back(p3);
-		m_Vertexdata.push_back(color);
-
-		m_Vertexdata.push_back(p0);
-		m_Vertexdata.push_back(color);
+		return false;
 	}
+	glGenVertexArrays(1,&m_VAO);
+	glBindVertexArray(m_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER,m_VertexBuffer.GetBuffer());
+	ColorVertex::GetLayout().Apply();
+	return true;
 }
-
 void RingRectShape::GetParticleVertexData()
 {
 	if(!m_ParticleInfoList.empty())
@@ -178,12 +124,9 @@ void RingRectShape::GetParticleVertexData()
 				auto pos11 = glm::vec4(pos1,1.0)*Model;
 				auto pos22 = glm::vec4(pos2,1.0)*Model;
 
-				m_ParticleVertex.push_back(pos00);
-				m_ParticleVertex.push_back(color);
-				m_ParticleVertex.push_back(pos11);
-				m_ParticleVertex.push_back(color);
-				m_ParticleVertex.push_back(pos22);
-				m_ParticleVertex.push_back(color);
+				m_ParticleVertex.emplace_back(glm::vec3(pos00),color);
+				m_ParticleVertex.emplace_back(glm::vec3(pos11),color);
+				m_ParticleVertex.emplace_back(glm::vec3(pos22),color);
 				index++;
 			}
 			else
@@ -228,12 +171,9 @@ void RingRectShape::GetParticleVertexData()
 		auto pos00 = glm::vec4(pos0,1.0)*Model;
 		auto pos11 = glm::vec4(pos1,1.0)*Model;
 		auto pos22 = glm::vec4(pos2,1.0)*Model;
-		m_ParticleVertex.push_back(pos00);
-		m_ParticleVertex.push_back(color);
-		m_ParticleVertex.push_back(pos11);
-		m_ParticleVertex.push_back(color);
-		m_ParticleVertex.push_back(pos22);
-		m_ParticleVertex.push_back(color);
+		m_ParticleVertex.emplace_back(glm::vec3(pos00),color);
+		m_ParticleVertex.emplace_back(glm::vec3(pos11),color);
+		m_ParticleVertex.emplace_back(glm::vec3(pos22),color);
 	}
 }
 
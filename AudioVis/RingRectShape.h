@@ -8,6 +8,11 @@
 
 #include "AudioVis.h"
 #include "DrawBase.h"
+#include "PolarBasis.h"
+#include "RadialBars.h"
+#include "SpectrumTexture.h"
+#include "StreamBuffer.h"
+#include "VertexFormat.h"
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
@@ -36,23 +41,30 @@ public:
 	virtual bool Init()override;
 
 	virtual void Draw(Visualizer* visualizer)override;
+
+	virtual void Release()override;
 private:
-	unsigned int GenVAO(const std::vector<float>& heigthlist);
-	void GetVetexData(const std::vector<float>& heigthlist);
-	unsigned int GenParticleVAO();
+	bool GenVAO();
 	void GetParticleVertexData();
 	glm::vec3 GenerateRandomRotate(std::uniform_real_distribution<>& dis,std::mt19937& gen);
 	glm::vec3 GenerateRandomScale(std::uniform_real_distribution<>& dis,std::mt19937& gen);
 private:
 	GLuint shader;
-	GLuint MVPID;
-	std::vector<glm::vec3> m_Vertexdata;
-	std::vector<glm::vec3> m_ParticleVertex;
+	GLint m_ModelID{ -1 };
+	glm::mat4 m_Model{ 1.0f };
+	std::vector<ColorVertex> m_ParticleVertex;
 	std::vector<ParticleInfo> m_ParticleInfoList;
 	glm::vec3 m_Rotate_min_bounds = glm::vec3(0,0,0);
 	glm::vec3 m_Rotate_max_bounds = glm::vec3(360,360,360);
 
 	glm::vec3 m_Scale_min_bounds = glm::vec3(0.5,0.5,1);
 	glm::vec3 m_Scale_max_bounds = glm::vec3(3,3,1);
+	// Particles: moved on the CPU, so still uploaded as vertices
+	GLuint m_VAO{ 0 };
+	StreamBuffer m_VertexBuffer;
+	// Bars: built in Shaders/RadialBars.vs from the heights alone
+	RadialBarProgram m_Bars;
+	RadialBarStyle m_BarStyle;
+	SpectrumTexture m_Heights;
 };
 
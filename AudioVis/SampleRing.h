@@ -0,0 +1,153 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "SFML/Config.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+//==============================================================
+// Lock-free single producer / single consumer sample ring.
+// The producer (audio callback) only ever pushes; the consumer
+// (analysis) copies the most recent window behind the write head.
+// The writer never waits for the reader: if the reader is lapped
+// while copying, ReadLatest reports it and the caller retries.
+// Pushes are published in pieces of at most maxPush samples, so a
+// reader treats that much space past the published write position
+// as possibly being written already.
+//==============================================================
+class SampleRing
+{
+public:
+	// Capacity is rounded up to a power of two; maxPush defaults to a
+	// quarter of it. Reads must leave maxPush of the capacity free.
+	explicit SampleRing(size_t capacity = 1<<17,size_t maxPush = 0)
+	{
+		size_t size = 1;
+		while(size<capacity)
+		{
+			size <<= 1;
+		}
+		m_Samples.resize(size);
+		m_Mask = size-1;
+		m_MaxPush = maxPush>0&&maxPush<size ? maxPush : size/4;
+	}
+
+	size_t GetCapacity() const
+	{
+		return m_Samples.size();
+	}
+
+	// Total number of samples ever pushed, used as the capture clock
+	unsigned long long GetWritePosition() const
+	{
+		return m_WritePos.load(std::memory_order_acquire);
+	}
+
+	// steady_clock time in nanoseconds at which the sample just before
+	// `position` was pushed; 0 once it is older than the last
+	// CAPTURE_PUSH_RECORDS pushes
+	long long GetPushTime(unsigned long long position) const
+	{
+		for(const PushRecord& record:m_Pushes)
+		{
+			if(record.end.load(std::memory_order_acquire)==position)
+			{
+				long long time = record.time.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				// Reused for a newer push while we read it
+				return record.end.load(std::memory_order_relaxed)==position ? time : 0;
+			}
+		}
+		return 0;
+	}
+
+	void Reset()
+	{
+		m_WritePos.store(0,std::memory_order_release);
+		for(PushRecord& record:m_Pushes)
+		{
+			record.end.store(0,std::memory_order_relaxed);
+		}
+		m_PushCount = 0;
+	}
+
+	// Called from the capture thread: no locks, no allocation
+	void Push(const sf::Int16* samples,size_t count)
+	{
+		auto now = std::chrono::steady_clock::now().time_since_epoch();
+		long long time = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+		unsigned long long pos = m_WritePos.load(std::memory_order_relaxed);
+		if(count>m_Samples.size())
+		{
+			samples += count-m_Samples.size();
+			pos += count-m_Samples.size();
+			count = m_Samples.size();
+		}
+		// Never more than m_MaxPush past the published position, the
+		// headroom ReadLatest allows for a push in progress
+		for(size_t done = 0; done<count;)
+		{
+			size_t piece = std::min(count-done,m_MaxPush);
+			for(size_t i = 0; i<piece; ++i)
+			{
+				m_Samples[(pos+i)&m_Mask] = samples[done+i];
+			}
+			pos += piece;
+			done += piece;
+			// Recorded before the samples are published, so a reader that
+			// sees this write position can look up when it arrived
+			PushRecord& record = m_Pushes[m_PushCount++%CAPTURE_PUSH_RECORDS];
+			record.end.store(0,std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			record.time.store(time,std::memory_order_relaxed);
+			record.end.store(pos,std::memory_order_release);
+			m_WritePos.store(pos,std::memory_order_release);
+		}
+	}
+
+	// Copies the newest `count` samples into dest (zero padded if not enough
+	// have been captured yet). Returns false if the producer overwrote the
+	// region while it was being copied, or may have been overwriting it.
+	// At most the capacity less the push headroom is copied; the rest of
+	// a larger count is padding.
+	bool ReadLatest(sf::Int16* dest,size_t count,unsigned long long* endPosition = nullptr) const
+	{
+		unsigned long long end = m_WritePos.load(std::memory_order_acquire);
+		size_t available = (size_t)std::min<unsigned long long>(end,std::min(count,m_Samples.size()-m_MaxPush));
+		size_t padding = count-available;
+		for(size_t i = 0; i<padding; ++i)
+		{
+			dest[i] = 0;
+		}
+		unsigned long long start = end-available;
+		for(size_t i = 0; i<available; ++i)
+		{
+			dest[padding+i] = m_Samples[(start+i)&m_Mask];
+		}
+		if(endPosition)
+		{
+			*endPosition = end;
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		// A push past the newest published position may already be writing
+		// up to m_MaxPush samples beyond it
+		return m_WritePos.load(std::memory_order_relaxed)+m_MaxPush-start<=m_Samples.size();
+	}
+
+private:
+	struct PushRecord
+	{
+		std::atomic<unsigned long long> end{ 0 };
+		std::atomic<long long> time{ 0 };
+	};
+
+	std::vector<sf::Int16> m_Samples;
+	size_t m_Mask{ 0 };
+	size_t m_MaxPush{ 0 };
+	std::atomic<unsigned long long> m_WritePos{ 0 };
+	PushRecord m_Pushes[CAPTURE_PUSH_RECORDS];
+	unsigned long long m_PushCount{ 0 };	// producer only
+};
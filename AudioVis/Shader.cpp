@@ -8,43 +8,30 @@
 #include <fstream>
 #include <algorithm>
 #include <sstream>
+#include <map>
 using namespace std;
 
 #include <stdlib.h>
 #include <string.h>
 
 #include "shader.hpp"
+#include "FrameUniforms.h"
+#include "ShaderCache.h"
+
+// Linked programs by ShaderCache key, so every shape asking for the same
+// pair shares one. Only the render thread loads shaders.
+static std::map<uint64_t,GLuint>& GetPrograms()
+{
+	static std::map<uint64_t,GLuint> programs;
+	return programs;
+}
 
-GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+static GLuint CompileProgram(const std::string& VertexShaderCode,const std::string& FragmentShaderCode,const char * vertex_file_path,const char * fragment_file_path,bool retrievable){
 
 	// Create the shaders
 	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
 	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
 
-	// Read the Vertex Shader code from the file
-	std::string VertexShaderCode;
-	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-	if(VertexShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << VertexShaderStream.rdbuf();
-		VertexShaderCode = sstr.str();
-		VertexShaderStream.close();
-	}else{
-		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path);
-		getchar();
-		return 0;
-	}
-
-	// Read the Fragment Shader code from the file
-	std::string FragmentShaderCode;
-	std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-	if(FragmentShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << FragmentShaderStream.rdbuf();
-		FragmentShaderCode = sstr.str();
-		FragmentShaderStream.close();
-	}
-
 	GLint Result = GL_FALSE;
 	int InfoLogLength;
 
@@ -86,6 +73,9 @@ GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path
 	// Link the program
 	printf("Linking program\n");
 	GLuint ProgramID = glCreateProgram();
+	if(retrievable){
+		glProgramParameteri(ProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 	glAttachShader(ProgramID, VertexShaderID);
 	glAttachShader(ProgramID, FragmentShaderID);
 	glLinkProgram(ProgramID);
@@ -109,4 +99,68 @@ GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path
 	return ProgramID;
 }
 
+GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+
+	// Read the Vertex Shader code from the file
+	std::string VertexShaderCode;
+	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
+	if(VertexShaderStream.is_open()){
+		std::stringstream sstr;
+		sstr << VertexShaderStream.rdbuf();
+		VertexShaderCode = sstr.str();
+		VertexShaderStream.close();
+	}else{
+		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path);
+		getchar();
+		return 0;
+	}
+
+	// Read the Fragment Shader code from the file
+	std::string FragmentShaderCode;
+	std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
+	if(FragmentShaderStream.is_open()){
+		std::stringstream sstr;
+		sstr << FragmentShaderStream.rdbuf();
+		FragmentShaderCode = sstr.str();
+		FragmentShaderStream.close();
+	}
+
+	uint64_t key = ShaderCache::MakeKey(VertexShaderCode,FragmentShaderCode);
+	GLuint& program = GetPrograms()[key];
+	if(program){
+		return program;
+	}
+
+	// A binary linked on an earlier run skips compiling altogether
+	ShaderCache cache;
+	bool cacheable = ShaderCache::IsSupported();
+	program = cacheable ? cache.Open(key) : 0;
+	if(!program){
+		program = CompileProgram(VertexShaderCode, FragmentShaderCode, vertex_file_path, fragment_file_path, cacheable);
+		GLint linked = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if(!linked){
+			// Don't keep a broken program around for the next caller to pick up
+			glDeleteProgram(program);
+			GetPrograms().erase(key);
+			return 0;
+		}
+		if(cacheable && !cache.Store(key, program)){
+			printf("Unable to write %s\n", cache.GetPath(key).c_str());
+		}
+	}
+
+	// Every program reads the camera and frame globals from the shared block;
+	// one loaded from a binary starts with default bindings too
+	FrameUniforms::Attach(program);
+	return program;
+}
+
+void ReleaseShaders(){
+	for(auto& program : GetPrograms()){
+		glDeleteProgram(program.second);
+	}
+	GetPrograms().clear();
+}
+
 
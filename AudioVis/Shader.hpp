@@ -6,6 +6,11 @@
 #define SHADER_HPP
 #include <GL/glew.h>
 
+// Programs are shared by everyone loading the same sources and owned by
+// the cache, so callers never delete them. Uniforms set on one are seen
+// by every other user of the same pair.
 GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path);
+// Deletes every loaded program; needs the GL context
+void ReleaseShaders();
 
 #endif
@@ -0,0 +1,151 @@
+#include "ShaderCache.h"
+#include "SpectrumCache.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char s_BinaryMagic[4] = { 'A','V','P','B' };
+
+ShaderCache::ShaderCache(const std::string& directory)
+	: m_Directory(directory)
+{
+}
+
+uint64_t ShaderCache::MakeKey(const std::string& vertexCode,const std::string& fragmentCode)
+{
+	// Binaries are only good for the driver that made them
+	uint64_t key = 0;
+	for(GLenum name:{ GL_VENDOR,GL_RENDERER,GL_VERSION })
+	{
+		const char* value = (const char*)glGetString(name);
+		if(value)
+		{
+			key = HashBytes(value,strlen(value),key);
+		}
+	}
+	key = HashBytes(vertexCode.data(),vertexCode.size(),key);
+	return HashBytes(fragmentCode.data(),fragmentCode.size(),key);
+}
+
+bool ShaderCache::IsSupported()
+{
+	if(!GLEW_VERSION_4_1&&!GLEW_ARB_get_program_binary)
+	{
+		return false;
+	}
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,&formats);
+	return formats>0;
+}
+
+std::string ShaderCache::GetPath(uint64_t key) const
+{
+	char name[32];
+	snprintf(name,sizeof(name),"%016llx",(unsigned long long)key);
+	return m_Directory+"/"+name+SHADER_CACHE_EXTENSION;
+}
+
+GLuint ShaderCache::Open(uint64_t key) const
+{
+	FILE* file = fopen(GetPath(key).c_str(),"rb");
+	if(!file)
+	{
+		return 0;
+	}
+	// The size field is checked against the file before anything is allocated
+	long fileSize = fseek(file,0,SEEK_END)==0 ? ftell(file) : -1;
+	rewind(file);
+	ProgramBinaryHeader header;
+	std::vector<char> binary;
+	bool ok = fileSize>=(long)sizeof(header)&&fread(&header,sizeof(header),1,file)==1&&memcmp(header.magic,s_BinaryMagic,4)==0
+		&&header.size<=(unsigned long)(fileSize-(long)sizeof(header));
+	if(ok)
+	{
+		binary.resize(header.size);
+		ok = header.size>0&&fread(binary.data(),1,binary.size(),file)==binary.size();
+	}
+	fclose(file);
+	if(!ok)
+	{
+		return 0;
+	}
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program,header.format,binary.data(),(GLsizei)binary.size());
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program,GL_LINK_STATUS,&linked);
+	if(!linked)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+bool ShaderCache::Store(uint64_t key,GLuint program) const
+{
+	GLint length = 0;
+	glGetProgramiv(program,GL_PROGRAM_BINARY_LENGTH,&length);
+	if(length<=0)
+	{
+		return false;
+	}
+	ProgramBinaryHeader header;
+	memcpy(header.magic,s_BinaryMagic,4);
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program,length,&length,&format,binary.data());
+	header.format = format;
+	header.size = (uint32_t)length;
+
+#ifdef _WIN32
+	int result = _mkdir(m_Directory.c_str());
+#else
+	int result = mkdir(m_Directory.c_str(),0755);
+#endif
+	if(result!=0&&errno!=EEXIST)
+	{
+		std::cout<<"Unable to create cache directory "<<m_Directory<<std::endl;
+		return false;
+	}
+
+	// Another instance starting at the same time renames a complete file too
+	std::string path = GetPath(key);
+#ifdef _WIN32
+	std::string temp = path+"."+std::to_string(GetCurrentProcessId())+".tmp";
+#else
+	std::string temp = path+"."+std::to_string(getpid())+".tmp";
+#endif
+	FILE* file = fopen(temp.c_str(),"wb");
+	if(!file)
+	{
+		return false;
+	}
+	fwrite(&header,sizeof(header),1,file);
+	fwrite(binary.data(),1,header.size,file);
+	bool ok = ferror(file)==0;
+	ok = fclose(file)==0&&ok;
+	if(ok)
+	{
+#ifdef _WIN32
+		ok = MoveFileExA(temp.c_str(),path.c_str(),MOVEFILE_REPLACE_EXISTING)!=0;
+#else
+		ok = rename(temp.c_str(),path.c_str())==0;
+#endif
+	}
+	if(!ok)
+	{
+		remove(temp.c_str());
+	}
+	return ok;
+}
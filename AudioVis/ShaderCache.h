@@ -0,0 +1,44 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "GL/glew.h"
+
+#include <stdint.h>
+#include <string>
+
+//==============================================================
+// Directory of linked program binaries named by a hash of the
+// shader sources and the driver (vendor, renderer and version), so
+// a later start on the same machine loads each program with
+// glProgramBinary instead of compiling it. A driver update changes
+// the key, and a binary the driver refuses anyway is just a miss.
+//
+// File layout: ProgramBinaryHeader, then size bytes of binary.
+//==============================================================
+struct ProgramBinaryHeader
+{
+	char magic[4];
+	uint32_t format;
+	uint32_t size;
+};
+
+class ShaderCache
+{
+public:
+	explicit ShaderCache(const std::string& directory = SHADER_CACHE_DIR);
+
+	// Needs the GL context for the driver strings
+	static uint64_t MakeKey(const std::string& vertexCode,const std::string& fragmentCode);
+	// GL 4.1 or ARB_get_program_binary, with at least one binary format
+	static bool IsSupported();
+	std::string GetPath(uint64_t key) const;
+
+	// A linked program from the cached binary; 0 on a miss
+	GLuint Open(uint64_t key) const;
+	// Link with GL_PROGRAM_BINARY_RETRIEVABLE_HINT for this to work.
+	// Creates the directory if needed and writes through a temporary file.
+	bool Store(uint64_t key,GLuint program) const;
+
+private:
+	std::string m_Directory;
+};
@@ -3,11 +3,20 @@
 layout(location = 0) in vec3 pos;
 layout(location = 1) in vec3 color;
 
-uniform mat4 MVP;
+layout(std140) uniform Frame
+{
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	float uTime;
+	float uLoudness;
+	float uBeatPhase;
+};
+uniform mat4 uModel;
 out vec4 outColor;
 void main(){
 
-	gl_Position =  MVP * vec4(pos,1.0);
+	gl_Position =  uViewProjection * uModel * vec4(pos,1.0);
 	outColor=vec4(color,1.0);
 }
 
@@ -0,0 +1,28 @@
+#version 330 core
+
+// A corner of the unit quad per vertex, a bar per instance
+layout(location = 0) in vec2 corner;
+layout(location = 1) in float height;
+
+layout(std140) uniform Frame
+{
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	float uTime;
+	float uLoudness;
+	float uBeatPhase;
+};
+uniform mat4 uModel;
+uniform float uBarWidth;
+uniform float uBarStep;
+uniform float uHeightScale;
+uniform vec3 uBottomColor;
+uniform vec3 uTopColor;
+out vec4 outColor;
+void main(){
+
+	vec3 pos = vec3(gl_InstanceID * uBarStep + corner.x * uBarWidth, corner.y * height * uHeightScale, 0.0);
+	gl_Position =  uViewProjection * uModel * vec4(pos,1.0);
+	outColor = vec4(mix(uBottomColor, uTopColor, corner.y), 1.0);
+}
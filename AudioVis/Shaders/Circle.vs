@@ -0,0 +1,59 @@
+#version 330 core
+
+// A triangle fan with no attributes: vertex 0 is the centre, vertex
+// i+1 rim point i. Rim point i sits at angle -i*2pi/uCount, 1+2*height
+// out; point uCount closes the fan at radius 1. With uOutline the rim
+// points are walked from vertex 0 instead, for a line strip back to
+// point 0.
+// uBasis is the PolarBasis table for uCount segments.
+layout(std140) uniform Frame
+{
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	float uTime;
+	float uLoudness;
+	float uBeatPhase;
+};
+uniform mat4 uModel;
+uniform samplerBuffer uBasis;
+uniform samplerBuffer uHeights;
+uniform int uFirst;
+uniform int uCount;
+uniform bool uOutline;
+uniform vec3 uCenterColor;
+uniform vec3 uRimColor;
+out vec4 outColor;
+
+vec3 RimPoint(int i){
+
+	float radius = 1.0;
+	if(i < uCount)
+	{
+		radius += 2.0 * texelFetch(uHeights, uFirst + i).r;
+	}
+	// Clockwise, so the table's sin is negated
+	vec2 dir = texelFetch(uBasis, i).xy * vec2(1.0, -1.0);
+	return vec3(radius * dir, 0.0);
+}
+
+void main(){
+
+	vec3 pos;
+	vec3 color = uRimColor;
+	if(uOutline)
+	{
+		pos = RimPoint(gl_VertexID % (uCount + 1));
+	}
+	else if(gl_VertexID == 0)
+	{
+		pos = vec3(0.0);
+		color = uCenterColor;
+	}
+	else
+	{
+		pos = RimPoint(gl_VertexID - 1);
+	}
+	gl_Position =  uViewProjection * uModel * vec4(pos,1.0);
+	outColor = vec4(color, 1.0);
+}
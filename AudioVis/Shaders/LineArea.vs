@@ -0,0 +1,28 @@
+#version 330 core
+
+// The area under the heights as one triangle strip with no attributes:
+// vertex 2i is the foot of height i at x=i*uSegment, vertex 2i+1 its top.
+layout(std140) uniform Frame
+{
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	float uTime;
+	float uLoudness;
+	float uBeatPhase;
+};
+uniform mat4 uModel;
+uniform samplerBuffer uHeights;
+uniform int uFirst;
+uniform float uSegment;
+uniform vec3 uColor;
+out vec4 outColor;
+
+void main(){
+
+	int i = gl_VertexID / 2;
+	float height = texelFetch(uHeights, uFirst + i).r;
+	vec3 pos = vec3(float(i) * uSegment, float(gl_VertexID % 2) * height, 0.0);
+	gl_Position =  uViewProjection * uModel * vec4(pos,1.0);
+	outColor = vec4(uColor, 1.0);
+}
@@ -1,13 +1,22 @@
 #version 330 core
 
+// A unit sphere, swollen and roughened here by the frame's loudness
 layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 color;
 layout(location = 2) in vec3 aNormal;
-layout(location = 3) in vec3 uv;
+layout(location = 3) in vec2 uv;
 
-uniform float uNoiseScale;
-uniform float uNoiseStrength;
-uniform mat4 MVP;
+uniform float uRadius;
+uniform vec3 uColor;
+layout(std140) uniform Frame
+{
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	float uTime;
+	float uLoudness;
+	float uBeatPhase;
+};
+uniform mat4 uModel;
 out vec4 outColor;
 out vec2 texCoord;
 
@@ -115,10 +124,11 @@ float hash(vec2 p) {
 void main()
 { 
    // float random = rand(aPos.xy);
-    float n = snoise(aPos * uNoiseScale);
-    vec3 displaced = aPos + aNormal * n * uNoiseStrength;
-    outColor=vec4(color,1.0);
-    texCoord=uv.xy;
-    gl_Position = MVP * vec4(displaced, 1.0);
+    vec3 pos = aPos * (uRadius + 2.0 * uLoudness);
+    float n = snoise(pos * 2.0 * uLoudness);
+    vec3 displaced = pos + aNormal * n * uLoudness;
+    outColor=vec4(uColor,1.0);
+    texCoord=uv;
+    gl_Position = uViewProjection * uModel * vec4(displaced, 1.0);
 }
 
@@ -0,0 +1,55 @@
+#version 330 core
+
+// Bars around a circle, drawn as a four vertex triangle strip per
+// instance with no attributes. Bar i
+// points at angle -i*2pi/segments, where uBasis is the PolarBasis
+// table for that many segments, and spans radius
+// uBaseRadius-uInner*len to uBaseRadius+uOuter*len, where len is its
+// height (0 past uCount) raised to at least uMinLength.
+layout(std140) uniform Frame
+{
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	float uTime;
+	float uLoudness;
+	float uBeatPhase;
+};
+uniform mat4 uModel;
+uniform samplerBuffer uBasis;
+uniform samplerBuffer uHeights;
+uniform int uFirst;
+uniform int uCount;
+uniform float uBaseRadius;
+uniform float uInner;
+uniform float uOuter;
+uniform float uMinLength;
+uniform float uHalfWidth;
+uniform vec3 uColor;
+out vec4 outColor;
+
+// Strip order: inner-, inner+, outer-, outer+
+const float along[4] = float[4](0.0, 0.0, 1.0, 1.0);
+const float side[4] = float[4](-1.0, 1.0, -1.0, 1.0);
+
+void main(){
+
+	int bar = gl_InstanceID;
+	int corner = gl_VertexID;
+	float len = 0.0;
+	if(bar < uCount)
+	{
+		len = texelFetch(uHeights, uFirst + bar).r;
+	}
+	len = max(len, uMinLength);
+	// Clockwise, so the table's sin is negated
+	vec2 dir = texelFetch(uBasis, bar).xy * vec2(1.0, -1.0);
+	float innerRadius = uBaseRadius - uInner * len;
+	vec2 inner = innerRadius * dir;
+	vec2 outer = (uBaseRadius + uOuter * len) * dir;
+	// The inner end's tangent, which flips if the bar reaches past the centre
+	vec2 tangent = sign(innerRadius) * vec2(-dir.y, dir.x);
+	vec2 pos = mix(inner, outer, along[corner]) + side[corner] * uHalfWidth * tangent;
+	gl_Position =  uViewProjection * uModel * vec4(pos, 0.0, 1.0);
+	outColor = vec4(uColor, 1.0);
+}
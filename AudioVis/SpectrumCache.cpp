@@ -0,0 +1,252 @@
+#include "SpectrumCache.h"
+#include "SFML/Audio/InputSoundFile.hpp"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+SpectrumCache::SpectrumCache(const std::string& directory)
+	: m_Directory(directory)
+{
+}
+
+uint64_t SpectrumCache::MakeKey(const sf::Int16* mono,size_t sampleCount,unsigned int sampleRate,int hop,const AudioAnalyzer& analyzer)
+{
+	return HashBytes(mono,sampleCount*sizeof(sf::Int16),ParameterKey(sampleRate,hop,analyzer));
+}
+
+uint64_t SpectrumCache::ParameterKey(unsigned int sampleRate,int hop,const AudioAnalyzer& analyzer)
+{
+	// Anything that changes the frames has to change the key
+	int32_t parameters[] =
+	{
+		SPECTRUM_ANALYSIS_VERSION,
+		(int32_t)sampleRate,
+		hop,
+		analyzer.GetFFTSize(),
+		analyzer.GetBinCount(),
+		(int32_t)(SPECTRUM_MIN_DB*100),
+		(int32_t)(SPECTRUM_MAX_DB*100),
+	};
+	return HashBytes(parameters,sizeof(parameters),0);
+}
+
+std::string SpectrumCache::GetPath(uint64_t key) const
+{
+	char name[32];
+	snprintf(name,sizeof(name),"%016llx",(unsigned long long)key);
+	return m_Directory+"/"+name+SPECTRUM_CACHE_EXTENSION;
+}
+
+bool SpectrumCache::Open(uint64_t key,SpectrumFile& file) const
+{
+	return file.Open(GetPath(key));
+}
+
+bool SpectrumCache::MakeDirectory() const
+{
+#ifdef _WIN32
+	int result = _mkdir(m_Directory.c_str());
+#else
+	int result = mkdir(m_Directory.c_str(),0755);
+#endif
+	if(result!=0&&errno!=EEXIST)
+	{
+		std::cout<<"Unable to create cache directory "<<m_Directory<<std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool SpectrumCache::Store(uint64_t key,const SpectrumData& spectrum) const
+{
+	return MakeDirectory()&&SaveSpectrumFile(spectrum,GetPath(key));
+}
+
+bool SpectrumCache::Load(const sf::Int16* mono,size_t sampleCount,unsigned int sampleRate,SpectrumFile& file,std::string* path) const
+{
+	AudioAnalyzer analyzer;
+	int hop = sampleRate/SPECTRUM_FRAME_RATE;
+	if(hop<=0)
+	{
+		std::cout<<"Sample rate "<<sampleRate<<" is too low to analyse"<<std::endl;
+		return false;
+	}
+	uint64_t key = MakeKey(mono,sampleCount,sampleRate,hop,analyzer);
+	if(path)
+	{
+		*path = GetPath(key);
+	}
+	if(Open(key,file))
+	{
+		return true;
+	}
+	SpectrumData spectrum;
+	analyzer.AnalyzeTrack(mono,sampleCount,sampleRate,hop,spectrum);
+	if(!Store(key,spectrum))
+	{
+		std::cout<<"Unable to write "<<GetPath(key)<<std::endl;
+		return false;
+	}
+	return Open(key,file);
+}
+
+bool SpectrumCache::LoadFile(const std::string& audioPath,std::string& path) const
+{
+	sf::InputSoundFile input;
+	if(!input.openFromFile(audioPath))
+	{
+		return false;
+	}
+	unsigned int sampleRate = input.getSampleRate();
+	unsigned int channels = input.getChannelCount();
+	int hop = sampleRate/SPECTRUM_FRAME_RATE;
+	if(hop<=0||channels==0)
+	{
+		std::cout<<"Sample rate "<<sampleRate<<" is too low to analyse"<<std::endl;
+		return false;
+	}
+	AudioAnalyzer analyzer;
+	std::vector<sf::Int16> interleaved((size_t)SPECTRUM_DECODE_FRAMES*channels);
+	std::vector<sf::Int16> mono;
+
+	// The key covers every sample, so the whole file is read once for it
+	StreamHash hash(ParameterKey(sampleRate,hop,analyzer));
+	while(size_t read = (size_t)input.read(interleaved.data(),interleaved.size()))
+	{
+		AudioAnalyzer::Downmix(interleaved.data(),read/channels,channels,mono);
+		hash.Add(mono.data(),mono.size()*sizeof(sf::Int16));
+	}
+	uint64_t key = hash.Finish();
+	path = GetPath(key);
+	SpectrumFile cached;
+	if(Open(key,cached))
+	{
+		return true;
+	}
+
+	// Then again for the frames, the same ones AnalyzeTrack makes, keeping
+	// only a chunk and one FFT window of audio
+	SpectrumFileWriter writer;
+	if(!MakeDirectory()||!writer.Open(path,analyzer.GetBinCount(),hop,sampleRate))
+	{
+		std::cout<<"Unable to write "<<path<<std::endl;
+		return false;
+	}
+	input.seek(0);
+	int fftSize = analyzer.GetFFTSize();
+	std::vector<sf::Int16> window;
+	std::vector<sf::Int16> padded(fftSize);
+	std::vector<float> frame(analyzer.GetBinCount());
+	unsigned long long windowStart = 0;
+	unsigned long long frameStart = 0;
+	unsigned long long total = 0;
+	bool end = false;
+	while(!end)
+	{
+		size_t read = (size_t)input.read(interleaved.data(),interleaved.size());
+		end = read==0;
+		AudioAnalyzer::Downmix(interleaved.data(),read/channels,channels,mono);
+		window.insert(window.end(),mono.begin(),mono.end());
+		total += mono.size();
+		// Frames whose window is complete; at the end, the rest padded with silence
+		for(; frameStart<total&&(end||frameStart+fftSize<=total); frameStart += hop)
+		{
+			size_t offset = (size_t)(frameStart-windowStart);
+			const sf::Int16* samples = &window[offset];
+			if(offset+fftSize>window.size())
+			{
+				std::copy(window.begin()+offset,window.end(),padded.begin());
+				std::fill(padded.begin()+(window.size()-offset),padded.end(),(sf::Int16)0);
+				samples = padded.data();
+			}
+			analyzer.Analyze(samples,frame.data());
+			if(!writer.Write(frame.data()))
+			{
+				std::cout<<"Unable to write "<<path<<std::endl;
+				return false;
+			}
+		}
+		size_t drop = (size_t)std::min<unsigned long long>(frameStart-windowStart,window.size());
+		window.erase(window.begin(),window.begin()+drop);
+		windowStart += drop;
+	}
+	if(!writer.Close())
+	{
+		std::cout<<"Unable to write "<<path<<std::endl;
+		return false;
+	}
+	return true;
+}
+
+// FNV-1a over 64-bit words with a final avalanche; enough to tell
+// tracks apart, not meant to resist deliberate collisions
+uint64_t HashBytes(const void* data,size_t size,uint64_t seed)
+{
+	StreamHash hash(seed);
+	hash.Add(data,size);
+	return hash.Finish();
+}
+
+#define HASH_PRIME 0x100000001b3ull
+
+StreamHash::StreamHash(uint64_t seed)
+	: m_Hash(0xcbf29ce484222325ull^seed)
+{
+}
+
+void StreamHash::Mix(const unsigned char* word)
+{
+	uint64_t value;
+	memcpy(&value,word,sizeof(value));
+	m_Hash = (m_Hash^value)*HASH_PRIME;
+}
+
+void StreamHash::Add(const void* data,size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	m_Size += size;
+	// Complete a word the last piece left unfinished
+	while(m_PendingSize>0&&size>0)
+	{
+		m_Pending[m_PendingSize++] = *bytes++;
+		--size;
+		if(m_PendingSize==8)
+		{
+			Mix(m_Pending);
+			m_PendingSize = 0;
+		}
+	}
+	for(; size>=8; bytes += 8,size -= 8)
+	{
+		Mix(bytes);
+	}
+	if(size>0)
+	{
+		memcpy(m_Pending,bytes,size);
+		m_PendingSize = size;
+	}
+}
+
+uint64_t StreamHash::Finish() const
+{
+	uint64_t hash = m_Hash;
+	// Bytes short of a whole word go in one at a time
+	for(size_t i = 0; i<m_PendingSize; ++i)
+	{
+		hash = (hash^m_Pending[i])*HASH_PRIME;
+	}
+	hash ^= m_Size;
+	hash ^= hash>>33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash>>33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash>>33;
+	return hash;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "AudioAnalyzer.h"
+#include "SpectrumFile.h"
+
+#include <stdint.h>
+#include <string>
+
+//==============================================================
+// Directory of analysed spectra named by a hash of the mono audio
+// and every analysis parameter, so a track that was played before
+// maps its spectrum instead of analysing again, whatever its path.
+//==============================================================
+class SpectrumCache
+{
+public:
+	explicit SpectrumCache(const std::string& directory = SPECTRUM_CACHE_DIR);
+
+	static uint64_t MakeKey(const sf::Int16* mono,size_t sampleCount,unsigned int sampleRate,int hop,const AudioAnalyzer& analyzer);
+	std::string GetPath(uint64_t key) const;
+
+	// Maps a cached spectrum; false on a miss
+	bool Open(uint64_t key,SpectrumFile& file) const;
+	// Creates the directory if needed and writes through a temporary file
+	bool Store(uint64_t key,const SpectrumData& spectrum) const;
+
+	// Hit or analyse-and-store, then map; path receives the cache file
+	bool Load(const sf::Int16* mono,size_t sampleCount,unsigned int sampleRate,SpectrumFile& file,std::string* path = nullptr) const;
+	// The same for a file too long to hold: it is decoded a chunk at a
+	// time, once for the key and on a miss again for the frames, which
+	// go straight to the cache file. path receives the cache file.
+	bool LoadFile(const std::string& audioPath,std::string& path) const;
+
+private:
+	static uint64_t ParameterKey(unsigned int sampleRate,int hop,const AudioAnalyzer& analyzer);
+	bool MakeDirectory() const;
+
+	std::string m_Directory;
+};
+
+uint64_t HashBytes(const void* data,size_t size,uint64_t seed);
+
+//==============================================================
+// HashBytes fed a piece at a time: any split of the same bytes
+// gives the same hash as one call over all of them
+//==============================================================
+class StreamHash
+{
+public:
+	explicit StreamHash(uint64_t seed);
+
+	void Add(const void* data,size_t size);
+	uint64_t Finish() const;
+
+private:
+	void Mix(const unsigned char* word);
+
+	uint64_t m_Hash;
+	uint64_t m_Size{ 0 };
+	unsigned char m_Pending[8];
+	size_t m_PendingSize{ 0 };
+};
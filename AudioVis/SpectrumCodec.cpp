@@ -0,0 +1,239 @@
+#include "SpectrumCodec.h"
+
+#include <math.h>
+#include <string.h>
+
+// Compression curve of the 8-bit levels
+#define QUANT_MU 255.0f
+#define QUANT_LEVELS 255
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 12
+#define LZ_MAX_OFFSET 65535
+
+struct LevelTable
+{
+	float values[QUANT_LEVELS+1];
+
+	LevelTable()
+	{
+		for(int i = 0; i<=QUANT_LEVELS; ++i)
+		{
+			values[i] = expm1f((float)i/QUANT_LEVELS*log1pf(QUANT_MU))/QUANT_MU;
+		}
+	}
+};
+
+void QuantizeFrame(const float* frame,int binCount,uint8_t* levels,float& scale)
+{
+	scale = 0;
+	for(int b = 0; b<binCount; ++b)
+	{
+		scale = frame[b]>scale ? frame[b] : scale;
+	}
+	if(scale<=0)
+	{
+		scale = 0;
+		memset(levels,0,binCount);
+		return;
+	}
+	float norm = QUANT_MU/scale;
+	float curve = QUANT_LEVELS/log1pf(QUANT_MU);
+	for(int b = 0; b<binCount; ++b)
+	{
+		float v = frame[b]>0 ? frame[b] : 0;
+		levels[b] = (uint8_t)(log1pf(v*norm)*curve+0.5f);
+	}
+}
+
+void DequantizeFrame(const uint8_t* levels,int binCount,float scale,float* frame)
+{
+	static const LevelTable table;
+	for(int b = 0; b<binCount; ++b)
+	{
+		frame[b] = table.values[levels[b]]*scale;
+	}
+}
+
+void EncodeSpectrumBlock(const float* frames,int frameCount,int binCount,std::vector<uint8_t>& out)
+{
+	size_t scaleBytes = frameCount*sizeof(float);
+	std::vector<uint8_t> raw(scaleBytes+(size_t)frameCount*binCount);
+	std::vector<uint8_t> previous(binCount),levels(binCount);
+	for(int f = 0; f<frameCount; ++f)
+	{
+		float scale;
+		QuantizeFrame(frames+(size_t)f*binCount,binCount,levels.data(),scale);
+		memcpy(&raw[f*sizeof(float)],&scale,sizeof(float));
+		uint8_t* dest = &raw[scaleBytes+(size_t)f*binCount];
+		for(int b = 0; b<binCount; ++b)
+		{
+			// Wraps modulo 256; the decoder wraps back
+			dest[b] = (uint8_t)(levels[b]-(f ? previous[b] : 0));
+		}
+		previous.swap(levels);
+	}
+	LzCompress(raw.data(),raw.size(),out);
+}
+
+bool DecodeSpectrumBlock(const uint8_t* data,size_t size,int frameCount,int binCount,float* frames,std::vector<uint8_t>& scratch)
+{
+	size_t scaleBytes = frameCount*sizeof(float);
+	scratch.resize(scaleBytes+(size_t)frameCount*binCount);
+	if(!LzDecompress(data,size,scratch.data(),scratch.size()))
+	{
+		return false;
+	}
+	uint8_t* levels = &scratch[scaleBytes];
+	for(int f = 0; f<frameCount; ++f)
+	{
+		uint8_t* current = levels+(size_t)f*binCount;
+		if(f)
+		{
+			const uint8_t* previous = current-binCount;
+			for(int b = 0; b<binCount; ++b)
+			{
+				current[b] = (uint8_t)(current[b]+previous[b]);
+			}
+		}
+		float scale;
+		memcpy(&scale,&scratch[f*sizeof(float)],sizeof(float));
+		DequantizeFrame(current,binCount,scale,frames+(size_t)f*binCount);
+	}
+	return true;
+}
+
+static uint32_t Read32(const uint8_t* p)
+{
+	uint32_t value;
+	memcpy(&value,p,sizeof(value));
+	return value;
+}
+
+static void WriteLength(size_t length,std::vector<uint8_t>& out)
+{
+	for(; length>=255; length -= 255)
+	{
+		out.push_back(255);
+	}
+	out.push_back((uint8_t)length);
+}
+
+static void WriteSequence(const uint8_t* literals,size_t literalLength,size_t offset,size_t matchLength,std::vector<uint8_t>& out)
+{
+	size_t matchCode = matchLength ? matchLength-LZ_MIN_MATCH : 0;
+	out.push_back((uint8_t)((literalLength<15 ? literalLength : 15)<<4|(matchCode<15 ? matchCode : 15)));
+	if(literalLength>=15)
+	{
+		WriteLength(literalLength-15,out);
+	}
+	out.insert(out.end(),literals,literals+literalLength);
+	if(matchLength==0)
+	{
+		return;
+	}
+	out.push_back((uint8_t)(offset&0xff));
+	out.push_back((uint8_t)(offset>>8));
+	if(matchCode>=15)
+	{
+		WriteLength(matchCode-15,out);
+	}
+}
+
+void LzCompress(const uint8_t* src,size_t size,std::vector<uint8_t>& out)
+{
+	out.clear();
+	std::vector<int64_t> table((size_t)1<<LZ_HASH_BITS,-1);
+	size_t anchor = 0;
+	size_t i = 0;
+	while(i+LZ_MIN_MATCH<=size)
+	{
+		uint32_t sequence = Read32(src+i);
+		uint32_t hash = (sequence*2654435761u)>>(32-LZ_HASH_BITS);
+		int64_t candidate = table[hash];
+		table[hash] = (int64_t)i;
+		if(candidate<0||i-(size_t)candidate>LZ_MAX_OFFSET||Read32(src+candidate)!=sequence)
+		{
+			++i;
+			continue;
+		}
+		size_t length = LZ_MIN_MATCH;
+		while(i+length<size&&src[candidate+length]==src[i+length])
+		{
+			++length;
+		}
+		WriteSequence(src+anchor,i-anchor,i-(size_t)candidate,length,out);
+		i += length;
+		anchor = i;
+	}
+	// The last sequence carries only literals
+	WriteSequence(src+anchor,size-anchor,0,0,out);
+}
+
+static bool ReadLength(const uint8_t*& ip,const uint8_t* end,size_t& length)
+{
+	uint8_t byte;
+	do
+	{
+		if(ip>=end)
+		{
+			return false;
+		}
+		byte = *ip++;
+		length += byte;
+	}
+	while(byte==255);
+	return true;
+}
+
+bool LzDecompress(const uint8_t* src,size_t size,uint8_t* dest,size_t destSize)
+{
+	const uint8_t* ip = src;
+	const uint8_t* end = src+size;
+	uint8_t* op = dest;
+	uint8_t* opEnd = dest+destSize;
+	while(ip<end)
+	{
+		uint8_t token = *ip++;
+		size_t literalLength = token>>4;
+		if(literalLength==15&&!ReadLength(ip,end,literalLength))
+		{
+			return false;
+		}
+		if(literalLength>(size_t)(end-ip)||literalLength>(size_t)(opEnd-op))
+		{
+			return false;
+		}
+		memcpy(op,ip,literalLength);
+		ip += literalLength;
+		op += literalLength;
+		if(ip==end)
+		{
+			break;
+		}
+		if(end-ip<2)
+		{
+			return false;
+		}
+		size_t offset = ip[0]|(size_t)ip[1]<<8;
+		ip += 2;
+		size_t matchLength = token&15;
+		if(matchLength==15&&!ReadLength(ip,end,matchLength))
+		{
+			return false;
+		}
+		matchLength += LZ_MIN_MATCH;
+		if(offset==0||offset>(size_t)(op-dest)||matchLength>(size_t)(opEnd-op))
+		{
+			return false;
+		}
+		// Byte by byte: the match may overlap the bytes it produces
+		const uint8_t* match = op-offset;
+		for(size_t k = 0; k<matchLength; ++k)
+		{
+			op[k] = match[k];
+		}
+		op += matchLength;
+	}
+	return op==opEnd;
+}
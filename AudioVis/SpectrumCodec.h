@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//==============================================================
+// Compact encoding of spectrum frames for the .avspec Q8 format.
+//
+// A block of frames is stored as
+//   float scale[frameCount]             per-frame peak
+//   uint8 level[frameCount][binCount]   log-quantised, each frame
+//                                       after the first as a delta
+//                                       from the one before
+// and the whole block is then LZ compressed. Quiet bins and slowly
+// varying ones turn into runs of zero deltas, which the LZ pass
+// collapses.
+//==============================================================
+
+// Maps v/scale in [0,1] onto 0..255 along a mu-law curve, so small
+// values keep more precision than a linear step would give them
+void QuantizeFrame(const float* frame,int binCount,uint8_t* levels,float& scale);
+void DequantizeFrame(const uint8_t* levels,int binCount,float scale,float* frame);
+
+void EncodeSpectrumBlock(const float* frames,int frameCount,int binCount,std::vector<uint8_t>& out);
+// scratch is reused between calls to avoid reallocating
+bool DecodeSpectrumBlock(const uint8_t* data,size_t size,int frameCount,int binCount,float* frames,std::vector<uint8_t>& scratch);
+
+// LZ4-style byte compressor: literal runs and back references of at
+// least four bytes within a 64 KB window, no entropy stage
+void LzCompress(const uint8_t* src,size_t size,std::vector<uint8_t>& out);
+bool LzDecompress(const uint8_t* src,size_t size,uint8_t* dest,size_t destSize);
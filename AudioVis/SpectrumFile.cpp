@@ -0,0 +1,494 @@
+#include "SpectrumFile.h"
+#include "SpectrumCodec.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Frames start on a cache line
+#define AVSPEC_DATA_ALIGN 64
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+	if(file==INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file,&size)||size.QuadPart==0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file,NULL,PAGE_READONLY,0,0,NULL);
+	if(!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	void* data = MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+	if(!data)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	m_File = file;
+	m_Mapping = mapping;
+	m_Size = (size_t)size.QuadPart;
+	m_Data = (const unsigned char*)data;
+#else
+	int file = open(path.c_str(),O_RDONLY);
+	if(file<0)
+	{
+		return false;
+	}
+	struct stat info;
+	if(fstat(file,&info)!=0||info.st_size==0)
+	{
+		close(file);
+		return false;
+	}
+	void* data = mmap(NULL,(size_t)info.st_size,PROT_READ,MAP_SHARED,file,0);
+	if(data==MAP_FAILED)
+	{
+		close(file);
+		return false;
+	}
+	m_File = file;
+	m_Size = (size_t)info.st_size;
+	m_Data = (const unsigned char*)data;
+#endif
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if(m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+	}
+	if(m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+	}
+	if(m_File)
+	{
+		CloseHandle(m_File);
+	}
+	m_Mapping = nullptr;
+	m_File = nullptr;
+#else
+	if(m_Data)
+	{
+		munmap((void*)m_Data,m_Size);
+	}
+	if(m_File>=0)
+	{
+		close(m_File);
+	}
+	m_File = -1;
+#endif
+	m_Data = nullptr;
+	m_Size = 0;
+}
+
+static size_t FormatSize(uint32_t format)
+{
+	return format==SPECTRUM_FLOAT16 ? sizeof(uint16_t) : sizeof(float);
+}
+
+static int BlockCount(uint32_t frameCount,int blockFrames)
+{
+	return (int)((frameCount+blockFrames-1)/blockFrames);
+}
+
+int GetBlockFrames(const AvSpecHeader& header)
+{
+	return header.blockFrames ? (int)header.blockFrames : SPECTRUM_BLOCK_FRAMES;
+}
+
+bool CheckSpectrumHeader(const AvSpecHeader& header,uint64_t fileSize,const std::string& path)
+{
+	if(fileSize<sizeof(AvSpecHeader)||memcmp(header.magic,AVSPEC_MAGIC,4)!=0)
+	{
+		std::cout<<path<<" is not a spectrum file"<<std::endl;
+		return false;
+	}
+	if(header.version!=AVSPEC_VERSION||header.format>SPECTRUM_Q8)
+	{
+		std::cout<<path<<" has unsupported version "<<header.version<<" format "<<header.format<<std::endl;
+		return false;
+	}
+	uint64_t expected = (uint64_t)header.frameCount*header.binCount*FormatSize(header.format);
+	if(header.format==SPECTRUM_Q8)
+	{
+		// Only the offset table; blocks are checked as they are decoded
+		expected = (BlockCount(header.frameCount,GetBlockFrames(header))+1)*sizeof(uint64_t);
+	}
+	if(header.dataSize<expected||header.dataOffset+header.dataSize>fileSize)
+	{
+		std::cout<<path<<" is truncated"<<std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool SpectrumFile::Open(const std::string& path)
+{
+	Close();
+	if(!m_File.Open(path))
+	{
+		return false;
+	}
+	const AvSpecHeader* header = (const AvSpecHeader*)m_File.GetData();
+	if(!CheckSpectrumHeader(*header,m_File.GetSize(),path))
+	{
+		Close();
+		return false;
+	}
+	m_Header = header;
+	m_Frames = m_File.GetData()+header->dataOffset;
+	m_BlockFrames = GetBlockFrames(*header);
+	return true;
+}
+
+void SpectrumFile::Close()
+{
+	m_Header = nullptr;
+	m_Frames = nullptr;
+	for(CachedBlock& cached:m_Cache)
+	{
+		cached.block = -1;
+	}
+	m_File.Close();
+}
+
+const float* SpectrumFile::GetFrame(int index) const
+{
+	if(m_Header->format==SPECTRUM_FLOAT32)
+	{
+		return (const float*)m_Frames+(size_t)index*m_Header->binCount;
+	}
+	const float* block = DecodeBlock(index/m_BlockFrames);
+	return block+(size_t)(index%m_BlockFrames)*m_Header->binCount;
+}
+
+void SpectrumFile::ReadFrame(int index,float* dest) const
+{
+	memcpy(dest,GetFrame(index),m_Header->binCount*sizeof(float));
+}
+
+const float* SpectrumFile::DecodeBlock(int block) const
+{
+	CachedBlock* slot = &m_Cache[0];
+	for(CachedBlock& cached:m_Cache)
+	{
+		if(cached.block==block)
+		{
+			cached.lastUse = ++m_UseCount;
+			return cached.frames.data();
+		}
+		if(cached.lastUse<slot->lastUse)
+		{
+			slot = &cached;
+		}
+	}
+
+	int binCount = (int)m_Header->binCount;
+	int first = block*m_BlockFrames;
+	int count = std::min(m_BlockFrames,(int)m_Header->frameCount-first);
+	slot->block = block;
+	slot->lastUse = ++m_UseCount;
+	slot->frames.assign((size_t)m_BlockFrames*binCount,0.0f);
+	if(m_Header->format==SPECTRUM_FLOAT16)
+	{
+		const uint16_t* src = (const uint16_t*)m_Frames+(size_t)first*binCount;
+		for(size_t i = 0; i<(size_t)count*binCount; ++i)
+		{
+			slot->frames[i] = HalfToFloat(src[i]);
+		}
+		return slot->frames.data();
+	}
+
+	const uint64_t* offsets = (const uint64_t*)m_Frames;
+	uint64_t start = offsets[block];
+	uint64_t end = offsets[block+1];
+	if(start>end||end>m_Header->dataSize||!DecodeSpectrumBlock(m_Frames+start,(size_t)(end-start),count,binCount,slot->frames.data(),m_Scratch))
+	{
+		// Corrupt blocks read as silence
+		std::cout<<"Spectrum block "<<block<<" is corrupt"<<std::endl;
+		std::fill(slot->frames.begin(),slot->frames.end(),0.0f);
+	}
+	return slot->frames.data();
+}
+
+static void InitHeader(AvSpecHeader& header,SpectrumFormat format,int frameCount,int binCount,int hop,int sampleRate)
+{
+	memset(&header,0,sizeof(header));
+	memcpy(header.magic,AVSPEC_MAGIC,4);
+	header.version = AVSPEC_VERSION;
+	header.headerSize = sizeof(AvSpecHeader);
+	header.format = format;
+	header.frameCount = frameCount;
+	header.binCount = binCount;
+	header.hop = hop;
+	header.sampleRate = sampleRate;
+	header.dataOffset = (sizeof(AvSpecHeader)+AVSPEC_DATA_ALIGN-1)/AVSPEC_DATA_ALIGN*AVSPEC_DATA_ALIGN;
+	header.dataSize = (uint64_t)frameCount*binCount*FormatSize(format);
+	header.blockFrames = SPECTRUM_BLOCK_FRAMES;
+}
+
+// Readers never see a half written file, and writers racing on the
+// same path each rename a complete file of their own
+static std::string TempPath(const std::string& path)
+{
+#ifdef _WIN32
+	unsigned long process = GetCurrentProcessId();
+#else
+	unsigned long process = (unsigned long)getpid();
+#endif
+	return path+"."+std::to_string(process)+"-"+std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()))+".tmp";
+}
+
+static FILE* BeginFile(const AvSpecHeader& header,const std::string& temp)
+{
+	FILE* file = fopen(temp.c_str(),"wb");
+	if(file)
+	{
+		fwrite(&header,sizeof(header),1,file);
+		static const char padding[AVSPEC_DATA_ALIGN] = {};
+		fwrite(padding,1,(size_t)header.dataOffset-sizeof(header),file);
+	}
+	return file;
+}
+
+// Closes the temporary file and renames it over path, or removes it
+static bool FinishFile(FILE* file,const std::string& temp,const std::string& path)
+{
+	bool ok = ferror(file)==0;
+	ok = fclose(file)==0&&ok;
+	if(ok)
+	{
+#ifdef _WIN32
+		ok = MoveFileExA(temp.c_str(),path.c_str(),MOVEFILE_REPLACE_EXISTING)!=0;
+#else
+		ok = rename(temp.c_str(),path.c_str())==0;
+#endif
+	}
+	if(!ok)
+	{
+		remove(temp.c_str());
+	}
+	return ok;
+}
+
+bool SaveSpectrumFile(const SpectrumData& spectrum,const std::string& path,SpectrumFormat format)
+{
+	AvSpecHeader header;
+	InitHeader(header,format,spectrum.frameCount,spectrum.binCount,spectrum.hop,spectrum.sampleRate);
+
+	std::vector<uint64_t> offsets;
+	std::vector<uint8_t> blocks;
+	if(format==SPECTRUM_Q8)
+	{
+		int blockCount = BlockCount(spectrum.frameCount,SPECTRUM_BLOCK_FRAMES);
+		offsets.resize(blockCount+1);
+		offsets[0] = offsets.size()*sizeof(uint64_t);
+		std::vector<uint8_t> encoded;
+		for(int b = 0; b<blockCount; ++b)
+		{
+			int first = b*SPECTRUM_BLOCK_FRAMES;
+			int count = std::min(SPECTRUM_BLOCK_FRAMES,spectrum.frameCount-first);
+			EncodeSpectrumBlock(spectrum.GetFrame(first),count,spectrum.binCount,encoded);
+			blocks.insert(blocks.end(),encoded.begin(),encoded.end());
+			offsets[b+1] = offsets[0]+blocks.size();
+		}
+		header.dataSize = offsets.back();
+	}
+
+	std::string temp = TempPath(path);
+	FILE* file = BeginFile(header,temp);
+	if(!file)
+	{
+		return false;
+	}
+	if(format==SPECTRUM_FLOAT32)
+	{
+		fwrite(spectrum.frames.data(),sizeof(float),spectrum.frames.size(),file);
+	}
+	else if(format==SPECTRUM_Q8)
+	{
+		fwrite(offsets.data(),sizeof(uint64_t),offsets.size(),file);
+		fwrite(blocks.data(),1,blocks.size(),file);
+	}
+	else
+	{
+		std::vector<uint16_t> halves(spectrum.frames.size());
+		for(size_t i = 0; i<halves.size(); ++i)
+		{
+			halves[i] = FloatToHalf(spectrum.frames[i]);
+		}
+		fwrite(halves.data(),sizeof(uint16_t),halves.size(),file);
+	}
+	return FinishFile(file,temp,path);
+}
+
+SpectrumFileWriter::SpectrumFileWriter()
+{
+}
+
+SpectrumFileWriter::~SpectrumFileWriter()
+{
+	Abort();
+}
+
+bool SpectrumFileWriter::Open(const std::string& path,int binCount,int hop,int sampleRate)
+{
+	Abort();
+	// The frame count is only known at Close
+	InitHeader(m_Header,SPECTRUM_FLOAT32,0,binCount,hop,sampleRate);
+	m_Path = path;
+	m_Temp = TempPath(path);
+	m_File = BeginFile(m_Header,m_Temp);
+	return m_File!=nullptr;
+}
+
+bool SpectrumFileWriter::Write(const float* frame)
+{
+	if(!m_File||fwrite(frame,sizeof(float),m_Header.binCount,m_File)!=m_Header.binCount)
+	{
+		return false;
+	}
+	++m_Header.frameCount;
+	return true;
+}
+
+bool SpectrumFileWriter::Close()
+{
+	if(!m_File)
+	{
+		return false;
+	}
+	m_Header.dataSize = (uint64_t)m_Header.frameCount*m_Header.binCount*sizeof(float);
+	bool ok = fseek(m_File,0,SEEK_SET)==0&&fwrite(&m_Header,sizeof(m_Header),1,m_File)==1;
+	FILE* file = m_File;
+	m_File = nullptr;
+	if(!ok)
+	{
+		fclose(file);
+		remove(m_Temp.c_str());
+		return false;
+	}
+	return FinishFile(file,m_Temp,m_Path);
+}
+
+void SpectrumFileWriter::Abort()
+{
+	if(m_File)
+	{
+		fclose(m_File);
+		remove(m_Temp.c_str());
+		m_File = nullptr;
+	}
+}
+
+uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits,&value,sizeof(bits));
+	uint32_t sign = (bits>>16)&0x8000;
+	int32_t exponent = (int32_t)((bits>>23)&0xff)-127+15;
+	uint32_t mantissa = bits&0x7fffff;
+	if(exponent<=0)
+	{
+		// Subnormal or zero
+		if(exponent<-10)
+		{
+			return (uint16_t)sign;
+		}
+		mantissa |= 0x800000;
+		uint32_t shift = (uint32_t)(14-exponent);
+		uint32_t half = mantissa>>shift;
+		if((mantissa>>(shift-1))&1)
+		{
+			++half;
+		}
+		return (uint16_t)(sign|half);
+	}
+	if(exponent>=31)
+	{
+		// Overflow, infinity and NaN
+		return (uint16_t)(sign|0x7c00|(((bits>>23)&0xff)==0xff&&mantissa ? 0x200 : 0));
+	}
+	uint32_t half = sign|((uint32_t)exponent<<10)|(mantissa>>13);
+	if(mantissa&0x1000)
+	{
+		// Round to nearest; a carry into the exponent is still correct
+		++half;
+	}
+	return (uint16_t)half;
+}
+
+float HalfToFloat(uint16_t value)
+{
+	uint32_t sign = (uint32_t)(value&0x8000)<<16;
+	uint32_t exponent = (value>>10)&0x1f;
+	uint32_t mantissa = value&0x3ff;
+	uint32_t bits;
+	if(exponent==0)
+	{
+		if(mantissa==0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			// Renormalise a subnormal
+			exponent = 127-15+1;
+			while(!(mantissa&0x400))
+			{
+				mantissa <<= 1;
+				--exponent;
+			}
+			bits = sign|(exponent<<23)|((mantissa&0x3ff)<<13);
+		}
+	}
+	else if(exponent==31)
+	{
+		bits = sign|0x7f800000|(mantissa<<13);
+	}
+	else
+	{
+		bits = sign|((exponent+127-15)<<23)|(mantissa<<13);
+	}
+	float result;
+	memcpy(&result,&bits,sizeof(result));
+	return result;
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "AudioAnalyzer.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+//==============================================================
+// .avspec: binary spectrum cache, little endian
+//
+//   AvSpecHeader (64 bytes)
+//   padding up to dataOffset
+//   float32/float16: frameCount x binCount samples, row major
+//   q8: (blockCount+1) uint64 block offsets from dataOffset, then
+//       blocks of blockFrames frames each (see SpectrumCodec.h)
+//
+// Files are memory mapped and float32 frames are read in place, so
+// opening one costs the same whatever its size. Other formats are
+// decoded a block at a time into a small cache.
+//==============================================================
+#define AVSPEC_MAGIC "AVSP"
+#define AVSPEC_VERSION 1
+
+enum SpectrumFormat
+{
+	SPECTRUM_FLOAT32 = 0,
+	SPECTRUM_FLOAT16 = 1,
+	SPECTRUM_Q8 = 2,
+};
+
+struct AvSpecHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t headerSize;
+	uint32_t format;
+	uint32_t frameCount;
+	uint32_t binCount;
+	uint32_t hop;
+	uint32_t sampleRate;
+	uint64_t dataOffset;
+	uint64_t dataSize;
+	uint32_t blockFrames;
+	uint32_t reserved[3];
+};
+
+//==============================================================
+// Read-only memory mapping of a whole file
+//==============================================================
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const std::string& path);
+	void Close();
+
+	const unsigned char* GetData() const
+	{
+		return m_Data;
+	}
+
+	size_t GetSize() const
+	{
+		return m_Size;
+	}
+
+private:
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const unsigned char* m_Data{ nullptr };
+	size_t m_Size{ 0 };
+#ifdef _WIN32
+	void* m_File{ nullptr };
+	void* m_Mapping{ nullptr };
+#else
+	int m_File{ -1 };
+#endif
+};
+
+//==============================================================
+// An opened .avspec file
+//==============================================================
+class SpectrumFile
+{
+public:
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const
+	{
+		return m_Header!=nullptr;
+	}
+
+	int GetFrameCount() const
+	{
+		return m_Header ? (int)m_Header->frameCount : 0;
+	}
+
+	int GetBinCount() const
+	{
+		return m_Header ? (int)m_Header->binCount : 0;
+	}
+
+	int GetHop() const
+	{
+		return m_Header ? (int)m_Header->hop : 0;
+	}
+
+	int GetSampleRate() const
+	{
+		return m_Header ? (int)m_Header->sampleRate : 0;
+	}
+
+	int FrameAtTime(double seconds) const
+	{
+		return SpectrumFrameAtTime(seconds,GetSampleRate(),GetHop(),GetFrameCount());
+	}
+
+	SpectrumFormat GetFormat() const
+	{
+		return m_Header ? (SpectrumFormat)m_Header->format : SPECTRUM_FLOAT32;
+	}
+
+	// In-place frame for float32 files. Other formats decode into the
+	// block cache; the pointer then stays valid until
+	// SPECTRUM_CACHE_BLOCKS other blocks have been read. Not thread safe.
+	const float* GetFrame(int index) const;
+
+	// Decodes a frame of any format into dest (binCount floats)
+	void ReadFrame(int index,float* dest) const;
+
+private:
+	struct CachedBlock
+	{
+		int block{ -1 };
+		unsigned int lastUse{ 0 };
+		std::vector<float> frames;
+	};
+
+	const float* DecodeBlock(int block) const;
+
+	MappedFile m_File;
+	const AvSpecHeader* m_Header{ nullptr };
+	const unsigned char* m_Frames{ nullptr };
+	int m_BlockFrames{ 0 };
+	mutable CachedBlock m_Cache[SPECTRUM_CACHE_BLOCKS];
+	mutable unsigned int m_UseCount{ 0 };
+	mutable std::vector<uint8_t> m_Scratch;
+};
+
+// Magic, version and sizes against the file length; prints why on failure
+bool CheckSpectrumHeader(const AvSpecHeader& header,uint64_t fileSize,const std::string& path);
+int GetBlockFrames(const AvSpecHeader& header);
+
+// Writes to a temporary file and renames it into place
+bool SaveSpectrumFile(const SpectrumData& spectrum,const std::string& path,SpectrumFormat format = SPECTRUM_FLOAT32);
+
+//==============================================================
+// Writes a float32 .avspec a frame at a time, so a long track's
+// spectrum never has to be held whole. Like SaveSpectrumFile it
+// goes to a temporary file; Close fills in the frame count and
+// renames it into place.
+//==============================================================
+class SpectrumFileWriter
+{
+public:
+	SpectrumFileWriter();
+	// An unfinished file is thrown away
+	~SpectrumFileWriter();
+
+	bool Open(const std::string& path,int binCount,int hop,int sampleRate);
+	// binCount floats
+	bool Write(const float* frame);
+	bool Close();
+	void Abort();
+
+private:
+	SpectrumFileWriter(const SpectrumFileWriter&) = delete;
+	SpectrumFileWriter& operator=(const SpectrumFileWriter&) = delete;
+
+	FILE* m_File{ nullptr };
+	std::string m_Path;
+	std::string m_Temp;
+	AvSpecHeader m_Header;
+};
+
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
@@ -0,0 +1,231 @@
+#include "SpectrumIO.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+bool SaveSpectrumJson(const SpectrumData& spectrum,const std::string& path)
+{
+	FILE* file = fopen(path.c_str(),"wb");
+	if(!file)
+	{
+		return false;
+	}
+	fputc('[',file);
+	for(int f = 0; f<spectrum.frameCount; ++f)
+	{
+		const float* frame = spectrum.GetFrame(f);
+		fputs(f ? ",\n[" : "\n[",file);
+		for(int b = 0; b<spectrum.binCount; ++b)
+		{
+			fprintf(file,b ? ",%.9g" : "%.9g",frame[b]);
+		}
+		fputc(']',file);
+	}
+	fputs("\n]\n",file);
+	bool ok = ferror(file)==0;
+	fclose(file);
+	return ok;
+}
+
+//==============================================================
+// Streaming scanner for an array of arrays of numbers. Reads the
+// file in fixed chunks and writes values straight into the flat
+// frame matrix; no DOM, and no copy of the text, is ever held.
+// Anything but well formed, non-empty frames of one width is an
+// error, as it was with the DOM parser.
+//==============================================================
+class SpectrumJsonScanner
+{
+public:
+	explicit SpectrumJsonScanner(SpectrumData& spectrum)
+		: m_Spectrum(spectrum)
+	{
+	}
+
+	bool Feed(const char* text,size_t length)
+	{
+		for(size_t i = 0; i<length; ++i)
+		{
+			char c = text[i];
+			if((c>='0'&&c<='9')||c=='-'||c=='+'||c=='.'||c=='e'||c=='E')
+			{
+				// Numbers may straddle two chunks, so collect them first
+				if(m_TokenLength==0&&m_Done)
+				{
+					return Fail("data after the array");
+				}
+				if(m_TokenLength==0&&!m_NeedValue)
+				{
+					return Fail("missing comma");
+				}
+				if(m_TokenLength+1>=sizeof(m_Token))
+				{
+					return Fail("number too long");
+				}
+				m_Token[m_TokenLength++] = c;
+				continue;
+			}
+			if(m_TokenLength>0&&!EndNumber())
+			{
+				return false;
+			}
+			switch(c)
+			{
+			case '[':
+				if(m_Done)
+				{
+					return Fail("data after the array");
+				}
+				if(m_Depth>0&&!m_NeedValue)
+				{
+					return Fail("missing comma");
+				}
+				if(++m_Depth>2)
+				{
+					return Fail("nested array");
+				}
+				m_NeedValue = true;
+				m_AfterComma = false;
+				m_Count = 0;
+				break;
+			case ']':
+				if(m_Depth==0)
+				{
+					return Fail("unbalanced ]");
+				}
+				if(m_AfterComma)
+				{
+					return Fail("missing value after comma");
+				}
+				if(m_Depth--==2&&!EndFrame())
+				{
+					return false;
+				}
+				// The closed array is a value of its parent
+				m_NeedValue = false;
+				m_Done = m_Depth==0;
+				break;
+			case ',':
+				if(m_Depth==0||m_NeedValue)
+				{
+					return Fail("missing value before comma");
+				}
+				m_NeedValue = true;
+				m_AfterComma = true;
+				break;
+			case ' ':
+			case '\t':
+			case '\r':
+			case '\n':
+				break;
+			default:
+				return Fail("unexpected character");
+			}
+		}
+		return true;
+	}
+
+	bool Finish()
+	{
+		if(m_TokenLength>0||m_Depth!=0)
+		{
+			return Fail("unexpected end of file");
+		}
+		if(m_Spectrum.frameCount==0)
+		{
+			return Fail("no frames");
+		}
+		return true;
+	}
+
+private:
+	bool EndNumber()
+	{
+		if(m_Depth!=2)
+		{
+			return Fail("number outside a frame");
+		}
+		m_Token[m_TokenLength] = '\0';
+		char* end = nullptr;
+		float value = strtof(m_Token,&end);
+		if(end!=m_Token+m_TokenLength)
+		{
+			return Fail("bad number");
+		}
+		m_TokenLength = 0;
+		// push_back grows geometrically; the frame count is not known up front
+		m_Spectrum.frames.push_back(value);
+		++m_Count;
+		m_NeedValue = false;
+		m_AfterComma = false;
+		return true;
+	}
+
+	bool EndFrame()
+	{
+		if(m_Count==0)
+		{
+			std::cout<<"Frame "<<m_Spectrum.frameCount<<" is empty"<<std::endl;
+			return false;
+		}
+		if(m_Spectrum.frameCount==0)
+		{
+			m_Spectrum.binCount = m_Count;
+		}
+		else if(m_Count!=m_Spectrum.binCount)
+		{
+			std::cout<<"Frame "<<m_Spectrum.frameCount<<" has "<<m_Count<<" bins, expected "<<m_Spectrum.binCount<<std::endl;
+			return false;
+		}
+		++m_Spectrum.frameCount;
+		return true;
+	}
+
+	bool Fail(const char* what)
+	{
+		std::cout<<"Spectrum JSON: "<<what<<std::endl;
+		return false;
+	}
+
+	SpectrumData& m_Spectrum;
+	char m_Token[64];
+	size_t m_TokenLength{ 0 };
+	int m_Depth{ 0 };
+	int m_Count{ 0 };
+	// After [ or , a value must follow, and only directly after [ may the
+	// array close; once the outer array closes nothing else may follow
+	bool m_NeedValue{ false };
+	bool m_AfterComma{ false };
+	bool m_Done{ false };
+};
+
+bool LoadSpectrumJson(const std::string& path,SpectrumData& spectrum)
+{
+	FILE* file = fopen(path.c_str(),"rb");
+	if(!file)
+	{
+		return false;
+	}
+	spectrum.frameCount = 0;
+	spectrum.binCount = 0;
+	spectrum.hop = 0;
+	spectrum.sampleRate = 0;
+	spectrum.frames.clear();
+	SpectrumJsonScanner scanner(spectrum);
+	char chunk[65536];
+	bool ok = true;
+	size_t length;
+	while(ok&&(length = fread(chunk,1,sizeof(chunk),file))>0)
+	{
+		ok = scanner.Feed(chunk,length);
+	}
+	ok = ok&&!ferror(file)&&scanner.Finish();
+	fclose(file);
+	if(!ok)
+	{
+		std::cout<<path<<" is not a spectrum array"<<std::endl;
+		spectrum.frameCount = 0;
+		spectrum.frames.clear();
+	}
+	return ok;
+}
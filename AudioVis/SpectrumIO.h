@@ -0,0 +1,16 @@
+#pragma once
+
+#include "AudioAnalyzer.h"
+
+#include <string>
+
+//==============================================================
+// Reading and writing analysed spectra on disk
+//==============================================================
+
+// Writes the frames as a JSON array of arrays, the layout of Resources/audioData.txt
+bool SaveSpectrumJson(const SpectrumData& spectrum,const std::string& path);
+
+// Streams a JSON array of arrays into the flat frames without building a
+// DOM; hop and sampleRate are left at 0
+bool LoadSpectrumJson(const std::string& path,SpectrumData& spectrum);
@@ -0,0 +1,291 @@
+#include "SpectrumNet.h"
+#include "SpectrumCodec.h"
+
+#include <chrono>
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib,"ws2_32.lib")
+typedef int socklen_t;
+#define CloseSocket closesocket
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define CloseSocket close
+#endif
+
+static bool InitSockets()
+{
+#ifdef _WIN32
+	static const bool started = []
+	{
+		WSADATA data;
+		return WSAStartup(MAKEWORD(2,2),&data)==0;
+	}();
+	return started;
+#else
+	return true;
+#endif
+}
+
+// A full socket buffer then fails the send at once instead of waiting
+static bool SetNonBlocking(intptr_t socket)
+{
+#ifdef _WIN32
+	u_long enable = 1;
+	return ioctlsocket((SOCKET)socket,FIONBIO,&enable)==0;
+#else
+	int flags = fcntl((int)socket,F_GETFL,0);
+	return flags>=0&&fcntl((int)socket,F_SETFL,flags|O_NONBLOCK)==0;
+#endif
+}
+
+static size_t PacketSize(int binCount)
+{
+	return sizeof(SpectrumPacketHeader)+binCount;
+}
+
+SpectrumSender::SpectrumSender()
+{
+}
+
+SpectrumSender::~SpectrumSender()
+{
+	Close();
+}
+
+bool SpectrumSender::Open(const std::string& address)
+{
+	Close();
+	std::string host = address;
+	std::string port = std::to_string(SPECTRUM_NET_PORT);
+	size_t colon = address.rfind(':');
+	if(colon!=std::string::npos)
+	{
+		host = address.substr(0,colon);
+		port = address.substr(colon+1);
+	}
+	addrinfo hints;
+	memset(&hints,0,sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	addrinfo* result = nullptr;
+	if(!InitSockets()||getaddrinfo(host.c_str(),port.c_str(),&hints,&result)!=0)
+	{
+		std::cout<<"Unable to resolve "<<address<<std::endl;
+		return false;
+	}
+	m_Address.assign((uint8_t*)result->ai_addr,(uint8_t*)result->ai_addr+result->ai_addrlen);
+	freeaddrinfo(result);
+
+	intptr_t sock = (intptr_t)socket(AF_INET,SOCK_DGRAM,IPPROTO_UDP);
+	if(sock==SPECTRUM_INVALID_SOCKET||!SetNonBlocking(sock))
+	{
+		std::cout<<"Unable to open a socket for "<<address<<std::endl;
+		if(sock!=SPECTRUM_INVALID_SOCKET)
+		{
+			CloseSocket(sock);
+		}
+		return false;
+	}
+	m_Socket = sock;
+	m_Sequence = 0;
+	m_Sent = 0;
+	m_Dropped = 0;
+	return true;
+}
+
+void SpectrumSender::Close()
+{
+	if(m_Socket!=SPECTRUM_INVALID_SOCKET)
+	{
+		Flush();
+		CloseSocket(m_Socket);
+		m_Socket = SPECTRUM_INVALID_SOCKET;
+	}
+	m_Sizes.clear();
+}
+
+void SpectrumSender::Send(const float* frame,int binCount,double time)
+{
+	if(m_Socket==SPECTRUM_INVALID_SOCKET||binCount<=0||PacketSize(binCount)>SPECTRUM_PACKET_MAX)
+	{
+		return;
+	}
+	if(PacketSize(binCount)>m_Stride)
+	{
+		// Queued packets are smaller and still fit at their offsets
+		Flush();
+		m_Stride = PacketSize(binCount);
+		m_Batch.resize(m_Stride*SPECTRUM_NET_BATCH);
+	}
+	uint8_t* packet = &m_Batch[m_Sizes.size()*m_Stride];
+	SpectrumPacketHeader header;
+	memset(&header,0,sizeof(header));
+	memcpy(header.magic,SPECTRUM_PACKET_MAGIC,4);
+	header.version = SPECTRUM_PACKET_VERSION;
+	header.binCount = (uint16_t)binCount;
+	header.sequence = m_Sequence++;
+	header.time = time;
+	QuantizeFrame(frame,binCount,packet+sizeof(header),header.scale);
+	memcpy(packet,&header,sizeof(header));
+	m_Sizes.push_back(PacketSize(binCount));
+	if(m_Sizes.size()==SPECTRUM_NET_BATCH)
+	{
+		Flush();
+	}
+}
+
+void SpectrumSender::Flush()
+{
+	size_t count = m_Sizes.size();
+	if(count==0||m_Socket==SPECTRUM_INVALID_SOCKET)
+	{
+		m_Sizes.clear();
+		return;
+	}
+	size_t sent = 0;
+#ifdef __linux__
+	mmsghdr messages[SPECTRUM_NET_BATCH];
+	iovec parts[SPECTRUM_NET_BATCH];
+	memset(messages,0,sizeof(messages));
+	for(size_t i = 0; i<count; ++i)
+	{
+		parts[i].iov_base = &m_Batch[i*m_Stride];
+		parts[i].iov_len = m_Sizes[i];
+		messages[i].msg_hdr.msg_name = m_Address.data();
+		messages[i].msg_hdr.msg_namelen = (socklen_t)m_Address.size();
+		messages[i].msg_hdr.msg_iov = &parts[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+	}
+	// Stops at the first datagram that does not fit; the rest are dropped
+	int result = sendmmsg((int)m_Socket,messages,(unsigned int)count,MSG_DONTWAIT);
+	sent = result>0 ? (size_t)result : 0;
+#else
+	for(size_t i = 0; i<count; ++i)
+	{
+		if(sendto(m_Socket,(const char*)&m_Batch[i*m_Stride],(int)m_Sizes[i],0,(const sockaddr*)m_Address.data(),(socklen_t)m_Address.size())<0)
+		{
+			break;
+		}
+		++sent;
+	}
+#endif
+	m_Sent += sent;
+	m_Dropped += count-sent;
+	m_Sizes.clear();
+}
+
+SpectrumSink::SpectrumSink()
+{
+}
+
+SpectrumSink::~SpectrumSink()
+{
+	Close();
+}
+
+bool SpectrumSink::Open(int port)
+{
+	Close();
+	intptr_t sock = InitSockets() ? (intptr_t)socket(AF_INET,SOCK_DGRAM,IPPROTO_UDP) : SPECTRUM_INVALID_SOCKET;
+	sockaddr_in address;
+	memset(&address,0,sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons((uint16_t)port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if(sock==SPECTRUM_INVALID_SOCKET||bind(sock,(const sockaddr*)&address,sizeof(address))!=0)
+	{
+		std::cout<<"Unable to listen on port "<<port<<std::endl;
+		if(sock!=SPECTRUM_INVALID_SOCKET)
+		{
+			CloseSocket(sock);
+		}
+		return false;
+	}
+	m_Socket = sock;
+	m_Received = 0;
+	m_Bytes = 0;
+	m_Lost = 0;
+	m_Malformed = 0;
+	m_NextSequence = 0;
+	return true;
+}
+
+void SpectrumSink::Close()
+{
+	if(m_Socket!=SPECTRUM_INVALID_SOCKET)
+	{
+		CloseSocket(m_Socket);
+		m_Socket = SPECTRUM_INVALID_SOCKET;
+	}
+}
+
+void SpectrumSink::Run(double seconds)
+{
+	typedef std::chrono::steady_clock Clock;
+	std::vector<uint8_t> packet(SPECTRUM_PACKET_MAX);
+	Clock::time_point start = Clock::now();
+	Clock::time_point report = start;
+	uint64_t reportReceived = 0;
+	uint64_t reportBytes = 0;
+	while(m_Socket!=SPECTRUM_INVALID_SOCKET)
+	{
+		double elapsed = std::chrono::duration<double>(Clock::now()-start).count();
+		if(seconds>0&&elapsed>=seconds)
+		{
+			break;
+		}
+		double sinceReport = std::chrono::duration<double>(Clock::now()-report).count();
+		if(sinceReport>=1.0)
+		{
+			std::cout<<"Sink: "<<(m_Received-reportReceived)/sinceReport<<" frames/s, "
+				<<(m_Bytes-reportBytes)/sinceReport/1024.0<<" KB/s, "<<m_Lost<<" lost, "<<m_Malformed<<" malformed"<<std::endl;
+			report = Clock::now();
+			reportReceived = m_Received;
+			reportBytes = m_Bytes;
+		}
+
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(m_Socket,&readable);
+		timeval timeout{ 0,100000 };
+		if(select((int)m_Socket+1,&readable,nullptr,nullptr,&timeout)<=0)
+		{
+			continue;
+		}
+		int size = (int)recv(m_Socket,(char*)packet.data(),(int)packet.size(),0);
+		SpectrumPacketHeader header;
+		if(size<(int)sizeof(header))
+		{
+			++m_Malformed;
+			continue;
+		}
+		memcpy(&header,packet.data(),sizeof(header));
+		if(memcmp(header.magic,SPECTRUM_PACKET_MAGIC,4)!=0||header.version!=SPECTRUM_PACKET_VERSION||size!=(int)PacketSize(header.binCount))
+		{
+			++m_Malformed;
+			continue;
+		}
+		// A sender restart begins at 0 again and is not counted as loss
+		if(header.sequence>m_NextSequence)
+		{
+			m_Lost += header.sequence-m_NextSequence;
+		}
+		m_NextSequence = header.sequence+1;
+		++m_Received;
+		m_Bytes += size;
+	}
+	std::cout<<"Sink total: "<<m_Received<<" frames, "<<m_Lost<<" lost, "<<m_Malformed<<" malformed"<<std::endl;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "AudioVis.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//==============================================================
+// Spectrum frames as UDP datagrams, for consumers that cannot map
+// the shared memory ring. One frame per datagram:
+//
+//   SpectrumPacketHeader (32 bytes, little endian)
+//   uint8 level[binCount]   QuantizeFrame levels
+//
+// Levels are mu-law (mu = 255), not linear. Each bin decodes as
+//
+//   value = scale * (pow(256, level/255.0) - 1) / 255
+//
+// so level 0 is 0 and level 255 is scale, the frame's peak; this is
+// DequantizeFrame.
+//
+// Sends never block: a datagram the socket buffer has no room for
+// is dropped and counted, so a slow reader loses frames instead of
+// holding up analysis. Readers spot drops as gaps in sequence.
+//==============================================================
+#define SPECTRUM_PACKET_MAGIC "AVSD"
+#define SPECTRUM_PACKET_VERSION 1
+
+// Largest UDP payload over IPv4
+#define SPECTRUM_PACKET_MAX 65507
+
+// Sockets are kept as intptr_t so SOCKET and int fit alike
+#define SPECTRUM_INVALID_SOCKET ((intptr_t)-1)
+
+#pragma pack(push,1)
+struct SpectrumPacketHeader
+{
+	char magic[4];
+	uint8_t version;
+	uint8_t reserved0;
+	uint16_t binCount;
+	uint64_t sequence;
+	double time;
+	float scale;
+	uint32_t reserved1;
+};
+#pragma pack(pop)
+
+//==============================================================
+// Sending side. Frames are queued by Send and go out together in
+// Flush, in one sendmmsg call on Linux.
+//==============================================================
+class SpectrumSender
+{
+public:
+	SpectrumSender();
+	~SpectrumSender();
+
+	// address is host[:port], SPECTRUM_NET_PORT if no port is given
+	bool Open(const std::string& address);
+	void Close();
+
+	bool IsOpen() const
+	{
+		return m_Socket!=SPECTRUM_INVALID_SOCKET;
+	}
+
+	// Quantises the frame into the batch; a full batch is flushed
+	void Send(const float* frame,int binCount,double time);
+	void Flush();
+
+	uint64_t GetSentCount() const
+	{
+		return m_Sent;
+	}
+
+	uint64_t GetDroppedCount() const
+	{
+		return m_Dropped;
+	}
+
+private:
+	SpectrumSender(const SpectrumSender&) = delete;
+	SpectrumSender& operator=(const SpectrumSender&) = delete;
+
+	intptr_t m_Socket{ SPECTRUM_INVALID_SOCKET };
+	std::vector<uint8_t> m_Address;
+	// SPECTRUM_NET_BATCH packets, each at a fixed stride
+	std::vector<uint8_t> m_Batch;
+	std::vector<size_t> m_Sizes;
+	size_t m_Stride{ 0 };
+	uint64_t m_Sequence{ 0 };
+	uint64_t m_Sent{ 0 };
+	uint64_t m_Dropped{ 0 };
+};
+
+//==============================================================
+// Test consumer: receives on a local port and reports throughput
+// and lost frames once a second
+//==============================================================
+class SpectrumSink
+{
+public:
+	SpectrumSink();
+	~SpectrumSink();
+
+	bool Open(int port);
+	void Close();
+
+	// Receives until `seconds` have passed, or forever when <= 0
+	void Run(double seconds);
+
+	uint64_t GetReceivedCount() const
+	{
+		return m_Received;
+	}
+
+	uint64_t GetLostCount() const
+	{
+		return m_Lost;
+	}
+
+private:
+	SpectrumSink(const SpectrumSink&) = delete;
+	SpectrumSink& operator=(const SpectrumSink&) = delete;
+
+	intptr_t m_Socket{ SPECTRUM_INVALID_SOCKET };
+	uint64_t m_Received{ 0 };
+	uint64_t m_Bytes{ 0 };
+	uint64_t m_Lost{ 0 };
+	uint64_t m_Malformed{ 0 };
+	uint64_t m_NextSequence{ 0 };
+};
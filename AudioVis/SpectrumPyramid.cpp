@@ -0,0 +1,85 @@
+#include "SpectrumPyramid.h"
+
+#include <algorithm>
+#include <string.h>
+
+void SpectrumPyramid::Reset(int binCount)
+{
+	m_BinCount = binCount;
+	m_PyramidSize = GetPyramidSize(binCount);
+	m_LevelStart.clear();
+	m_LevelSize.clear();
+	for(int size = binCount,start = 0; size>0; size = size>1 ? (size+1)/2 : 0)
+	{
+		m_LevelStart.push_back(start);
+		m_LevelSize.push_back(size);
+		start += size;
+	}
+	m_Levels.assign((size_t)SPECTRUM_PYRAMID_CACHE_FRAMES*m_PyramidSize,0.0f);
+	m_SlotFrame.assign(SPECTRUM_PYRAMID_CACHE_FRAMES,-1);
+	m_Prefix.assign(binCount+1,0.0);
+}
+
+int SpectrumPyramid::LevelForBands(int bandCount) const
+{
+	int level = 0;
+	while(level+1<GetLevelCount()&&m_LevelSize[level+1]>=bandCount)
+	{
+		++level;
+	}
+	return level;
+}
+
+FrameSpan SpectrumPyramid::GetLevel(int frame,int level,FrameSpan base)
+{
+	if(frame<0||m_SlotFrame.empty()||level>=GetLevelCount()||(int)base.size()<m_BinCount)
+	{
+		return FrameSpan();
+	}
+	int slot = frame%SPECTRUM_PYRAMID_CACHE_FRAMES;
+	float* pyramid = &m_Levels[(size_t)slot*m_PyramidSize];
+	if(m_SlotFrame[slot]!=frame)
+	{
+		Build(base.data(),pyramid);
+		m_SlotFrame[slot] = frame;
+	}
+	return FrameSpan(pyramid+m_LevelStart[level],m_LevelSize[level]);
+}
+
+void SpectrumPyramid::Build(const float* frame,float* out)
+{
+	int binCount = m_BinCount;
+	memcpy(out,frame,binCount*sizeof(float));
+	// Band i of level L covers bins [i<<L,(i+1)<<L), clipped to the frame,
+	// so a short tail band is still the true mean of the bins it covers
+	double* prefix = m_Prefix.data();
+	for(int b = 0; b<binCount; ++b)
+	{
+		prefix[b+1] = prefix[b]+frame[b];
+	}
+	float* dest = out+binCount;
+	for(int size = (binCount+1)/2,width = 2; binCount>1; size = (size+1)/2,width *= 2)
+	{
+		for(int i = 0; i<size; ++i)
+		{
+			int first = i*width;
+			int last = std::min(first+width,binCount);
+			dest[i] = (float)((prefix[last]-prefix[first])/(last-first));
+		}
+		dest += size;
+		if(size==1)
+		{
+			break;
+		}
+	}
+}
+
+int SpectrumPyramid::GetPyramidSize(int binCount)
+{
+	int total = 0;
+	for(int size = binCount; size>0; size = size>1 ? (size+1)/2 : 0)
+	{
+		total += size;
+	}
+	return total;
+}
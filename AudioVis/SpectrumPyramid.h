@@ -0,0 +1,53 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "FrameSpan.h"
+
+#include <vector>
+
+//==============================================================
+// Mip-style reductions of each spectrum frame: level 0 is the
+// frame itself and every level averages pairs of bands from the
+// one below, down to a single band holding the frame mean.
+// Levels are built the first time a frame is asked for and kept
+// in SPECTRUM_PYRAMID_CACHE_FRAMES slots, so memory stays the same
+// however long the spectrum is.
+//==============================================================
+class SpectrumPyramid
+{
+public:
+	void Reset(int binCount);
+
+	int GetLevelCount() const
+	{
+		return (int)m_LevelStart.size();
+	}
+
+	int GetLevelSize(int level) const
+	{
+		return m_LevelSize[level];
+	}
+
+	// Deepest level with at least bandCount bands
+	int LevelForBands(int bandCount) const;
+
+	// base is the level 0 frame, read only when the frame is not cached.
+	// The span lasts until another frame takes its slot.
+	FrameSpan GetLevel(int frame,int level,FrameSpan base);
+
+	static int GetPyramidSize(int binCount);
+
+private:
+	// Writes every level of one frame, level 0 first, into out
+	void Build(const float* frame,float* out);
+
+	int m_BinCount{ 0 };
+	int m_PyramidSize{ 0 };
+	std::vector<int> m_LevelStart;
+	std::vector<int> m_LevelSize;
+	// Slot frame % SPECTRUM_PYRAMID_CACHE_FRAMES holds the frame m_SlotFrame names
+	std::vector<float> m_Levels;
+	std::vector<int> m_SlotFrame;
+	// Running sums of the frame being built, sized once per bin count
+	std::vector<double> m_Prefix;
+};
@@ -0,0 +1,373 @@
+#include "SpectrumShm.h"
+
+#include <chrono>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Attempts before ReadLatest gives up on a publisher that keeps lapping it
+#define SPECTRUM_SHM_READ_RETRIES 16
+
+SharedMemory::SharedMemory()
+{
+}
+
+SharedMemory::~SharedMemory()
+{
+	Close();
+}
+
+bool SharedMemory::Open(const std::string& name,size_t size,bool create)
+{
+	Close();
+#ifdef _WIN32
+	std::string section = "Local\\"+name;
+	HANDLE mapping;
+	bool existed = false;
+	if(create)
+	{
+		mapping = CreateFileMappingA(INVALID_HANDLE_VALUE,NULL,PAGE_READWRITE,(DWORD)((uint64_t)size>>32),(DWORD)size,section.c_str());
+		// A section readers still hold can't be replaced: this hands back
+		// the old one, at its old size
+		existed = mapping&&GetLastError()==ERROR_ALREADY_EXISTS;
+	}
+	else
+	{
+		mapping = OpenFileMappingA(FILE_MAP_READ,FALSE,section.c_str());
+	}
+	if(!mapping)
+	{
+		return false;
+	}
+	void* data = MapViewOfFile(mapping,create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ,0,0,0);
+	if(!data)
+	{
+		CloseHandle(mapping);
+		return false;
+	}
+	if(!create||existed)
+	{
+		MEMORY_BASIC_INFORMATION info;
+		SIZE_T mapped = VirtualQuery(data,&info,sizeof(info)) ? info.RegionSize : 0;
+		if(mapped<size)
+		{
+			UnmapViewOfFile(data);
+			CloseHandle(mapping);
+			return false;
+		}
+		size = mapped;
+	}
+	m_Mapping = mapping;
+#else
+	std::string path = "/"+name;
+	int file;
+	if(create)
+	{
+		// Start from a fresh object so a ring of another size is never reused
+		shm_unlink(path.c_str());
+		file = shm_open(path.c_str(),O_CREAT|O_EXCL|O_RDWR,0644);
+		if(file>=0&&ftruncate(file,(off_t)size)!=0)
+		{
+			close(file);
+			shm_unlink(path.c_str());
+			return false;
+		}
+	}
+	else
+	{
+		file = shm_open(path.c_str(),O_RDONLY,0);
+		struct stat info;
+		if(file>=0&&fstat(file,&info)==0)
+		{
+			size = (size_t)info.st_size;
+		}
+	}
+	if(file<0)
+	{
+		return false;
+	}
+	void* data = size ? mmap(NULL,size,create ? PROT_READ|PROT_WRITE : PROT_READ,MAP_SHARED,file,0) : MAP_FAILED;
+	// The mapping keeps the object alive
+	close(file);
+	if(data==MAP_FAILED)
+	{
+		if(create)
+		{
+			shm_unlink(path.c_str());
+		}
+		return false;
+	}
+#endif
+	m_Data = (unsigned char*)data;
+	m_Size = size;
+	m_Owner = create;
+	m_Name = name;
+	return true;
+}
+
+void SharedMemory::Close()
+{
+#ifdef _WIN32
+	if(m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+	}
+	if(m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+	}
+	m_Mapping = nullptr;
+#else
+	if(m_Data)
+	{
+		munmap(m_Data,m_Size);
+		if(m_Owner)
+		{
+			shm_unlink(("/"+m_Name).c_str());
+		}
+	}
+#endif
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Owner = false;
+}
+
+static uint32_t SlotStride(int binCount)
+{
+	size_t size = sizeof(SpectrumShmSlot)+binCount*sizeof(float);
+	return (uint32_t)((size+63)/64*64);
+}
+
+static SpectrumShmSlot* GetSlot(const SpectrumShmHeader* header,uint64_t index)
+{
+	unsigned char* base = (unsigned char*)header+sizeof(SpectrumShmHeader);
+	return (SpectrumShmSlot*)(base+(size_t)(index%header->slotCount)*header->slotStride);
+}
+
+bool SpectrumPublisher::Open(const std::string& name,int binCount,int slotCount)
+{
+	Close();
+	size_t size = sizeof(SpectrumShmHeader)+(size_t)slotCount*SlotStride(binCount);
+	if(binCount<=0||slotCount<=0||!m_Memory.Open(name,size,true))
+	{
+		std::cout<<"Unable to create shared memory "<<name<<std::endl;
+		return false;
+	}
+	// Fresh regions are zero filled, and a reused one (Windows, while readers
+	// hold it) only ever has even sequences, so every sequence starts even
+	SpectrumShmHeader* header = (SpectrumShmHeader*)m_Memory.GetData();
+	memset(header->magic,0,4);
+	header->generation.fetch_add(1,std::memory_order_relaxed);
+	header->version = SPECTRUM_SHM_VERSION;
+	header->binCount = binCount;
+	header->slotCount = slotCount;
+	header->slotStride = SlotStride(binCount);
+	header->publishCount.store(0,std::memory_order_relaxed);
+	// Readers check the magic last
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(header->magic,SPECTRUM_SHM_MAGIC,4);
+	m_Header = header;
+	m_FrameIndex = 0;
+	return true;
+}
+
+void SpectrumPublisher::Close()
+{
+	if(m_Header)
+	{
+		// Before the name is unlinked, so readers know to look it up again
+		m_Header->generation.fetch_add(1,std::memory_order_release);
+	}
+	m_Header = nullptr;
+	m_Memory.Close();
+}
+
+void SpectrumPublisher::Publish(const float* frame,double time)
+{
+	uint64_t count = m_Header->publishCount.load(std::memory_order_relaxed);
+	SpectrumShmSlot* slot = GetSlot(m_Header,count);
+	uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+	slot->sequence.store(sequence+1,std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot->frameIndex = m_FrameIndex++;
+	slot->time = time;
+	memcpy((float*)(slot+1),frame,m_Header->binCount*sizeof(float));
+	slot->sequence.store(sequence+2,std::memory_order_release);
+	m_Header->publishCount.store(count+1,std::memory_order_release);
+}
+
+bool SpectrumSubscriber::Open(const std::string& name)
+{
+	Close();
+	if(!m_Memory.Open(name,0,false))
+	{
+		return false;
+	}
+	const SpectrumShmHeader* header = (const SpectrumShmHeader*)m_Memory.GetData();
+	if(m_Memory.GetSize()<sizeof(SpectrumShmHeader)||memcmp(header->magic,SPECTRUM_SHM_MAGIC,4)!=0||header->version!=SPECTRUM_SHM_VERSION
+		||sizeof(SpectrumShmHeader)+(size_t)header->slotCount*header->slotStride>m_Memory.GetSize())
+	{
+		std::cout<<"Shared memory "<<name<<" is not a spectrum ring"<<std::endl;
+		Close();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	m_Header = header;
+	m_Generation = header->generation.load(std::memory_order_relaxed);
+	return true;
+}
+
+void SpectrumSubscriber::Close()
+{
+	m_Header = nullptr;
+	m_Memory.Close();
+}
+
+bool SpectrumSubscriber::IsStale() const
+{
+	return m_Header&&m_Header->generation.load(std::memory_order_acquire)!=m_Generation;
+}
+
+bool SpectrumSubscriber::AcquireLatest(SpectrumView& view) const
+{
+	uint64_t count = m_Header&&!IsStale() ? m_Header->publishCount.load(std::memory_order_acquire) : 0;
+	if(count==0)
+	{
+		return false;
+	}
+	const SpectrumShmSlot* slot = GetSlot(m_Header,count-1);
+	uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+	if(sequence&1)
+	{
+		// Lapped mid-write; the slot before is complete
+		if(count<2)
+		{
+			return false;
+		}
+		slot = GetSlot(m_Header,count-2);
+		sequence = slot->sequence.load(std::memory_order_acquire);
+		if(sequence&1)
+		{
+			return false;
+		}
+	}
+	view.slot = slot;
+	view.sequence = sequence;
+	view.frameIndex = slot->frameIndex;
+	view.time = slot->time;
+	view.bins = (const float*)(slot+1);
+	return true;
+}
+
+bool SpectrumSubscriber::IsValid(const SpectrumView& view) const
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return view.slot&&!IsStale()&&view.slot->sequence.load(std::memory_order_relaxed)==view.sequence;
+}
+
+bool SpectrumSubscriber::ReadLatest(float* dest,uint64_t* frameIndex,int* torn) const
+{
+	if(torn)
+	{
+		*torn = 0;
+	}
+	for(int attempt = 0; attempt<SPECTRUM_SHM_READ_RETRIES; ++attempt)
+	{
+		SpectrumView view;
+		if(!AcquireLatest(view))
+		{
+			return false;
+		}
+		memcpy(dest,view.bins,m_Header->binCount*sizeof(float));
+		if(IsValid(view))
+		{
+			if(frameIndex)
+			{
+				*frameIndex = view.frameIndex;
+			}
+			return true;
+		}
+		if(torn)
+		{
+			++*torn;
+		}
+	}
+	return false;
+}
+
+void SpectrumMonitor::Run(const std::string& name,double seconds)
+{
+	typedef std::chrono::steady_clock Clock;
+	std::vector<float> frame;
+	Clock::time_point start = Clock::now();
+	Clock::time_point report = start;
+	uint64_t reportFrames = 0;
+	uint64_t lastIndex = 0;
+	bool haveIndex = false;
+	bool opened = false;
+	for(;;)
+	{
+		double elapsed = std::chrono::duration<double>(Clock::now()-start).count();
+		if(seconds>0&&elapsed>=seconds)
+		{
+			break;
+		}
+		double sinceReport = std::chrono::duration<double>(Clock::now()-report).count();
+		if(sinceReport>=1.0)
+		{
+			std::cout<<"Subscriber: "<<(m_Frames-reportFrames)/sinceReport<<" frames/s, "<<m_Skipped<<" skipped, "
+				<<m_Retries<<" retried reads, "<<m_Failed<<" failed reads, "<<m_Reopens<<" reopens"<<std::endl;
+			report = Clock::now();
+			reportFrames = m_Frames;
+		}
+
+		if(m_Subscriber.GetBinCount()==0||m_Subscriber.IsStale())
+		{
+			if(!m_Subscriber.Open(name))
+			{
+				// Not published yet, or between a close and the next open
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				continue;
+			}
+			m_Reopens += opened ? 1 : 0;
+			opened = true;
+			frame.resize(m_Subscriber.GetBinCount());
+			haveIndex = false;
+		}
+		uint64_t index;
+		int torn;
+		bool read = m_Subscriber.ReadLatest(frame.data(),&index,&torn);
+		m_Retries += torn;
+		if(!read)
+		{
+			// Gave up after being lapped on every attempt
+			m_Failed += torn>0 ? 1 : 0;
+		}
+		else if(!haveIndex||index!=lastIndex)
+		{
+			// A publisher restart begins at 0 again and is not counted as skipped
+			if(haveIndex&&index>lastIndex+1)
+			{
+				m_Skipped += index-lastIndex-1;
+			}
+			lastIndex = index;
+			haveIndex = true;
+			++m_Frames;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	std::cout<<"Subscriber total: "<<m_Frames<<" frames, "<<m_Skipped<<" skipped, "<<m_Retries<<" retried reads, "
+		<<m_Failed<<" failed reads, "<<m_Reopens<<" reopens"<<std::endl;
+}
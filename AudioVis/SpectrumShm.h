@@ -0,0 +1,183 @@
+#pragma once
+
+#include "AudioVis.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+//==============================================================
+// Spectrum frames shared with other local processes (lighting
+// controllers, LED daemons...) through a named shared memory ring,
+// so the audio is analysed once per machine.
+//
+//   SpectrumShmHeader (64 bytes)
+//   slotCount x { SpectrumShmSlot, binCount floats }, each padded
+//   to a multiple of 64 bytes
+//
+// Each slot is a seqlock: the publisher makes its sequence odd while
+// writing and even again when done, so a reader that sees the same
+// even sequence before and after reading has a whole frame. Only the
+// publisher writes; any number of readers may map the ring.
+//
+// A reader keeps whatever region it mapped, so when the publisher
+// closes or recreates the ring (a new bin count) it bumps generation
+// first; readers that see it change reopen by name.
+//==============================================================
+#define SPECTRUM_SHM_MAGIC "AVSH"
+#define SPECTRUM_SHM_VERSION 2
+
+struct SpectrumShmHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t binCount;
+	uint32_t slotCount;
+	uint32_t slotStride;
+	// Bumped when the ring is initialised and again when it is closed
+	std::atomic<uint32_t> generation;
+	// Frames published so far; the newest is in slot (count-1)%slotCount
+	std::atomic<uint64_t> publishCount;
+	uint64_t reserved[4];
+};
+
+struct SpectrumShmSlot
+{
+	std::atomic<uint64_t> sequence;
+	uint64_t frameIndex;
+	double time;
+	uint64_t reserved;
+};
+
+// Atomics in the ring are shared between processes, which only works if
+// they are plain machine words rather than emulated with a local lock
+static_assert(ATOMIC_INT_LOCK_FREE==2&&ATOMIC_LONG_LOCK_FREE==2&&ATOMIC_LLONG_LOCK_FREE==2,
+	"spectrum ring needs lock-free 32 and 64 bit atomics");
+
+//==============================================================
+// Named shared memory mapping, POSIX shm_open or a Windows
+// page-file backed section
+//==============================================================
+class SharedMemory
+{
+public:
+	SharedMemory();
+	~SharedMemory();
+
+	// create sizes a new region; otherwise an existing one is mapped whole
+	bool Open(const std::string& name,size_t size,bool create);
+	void Close();
+
+	unsigned char* GetData() const
+	{
+		return m_Data;
+	}
+
+	size_t GetSize() const
+	{
+		return m_Size;
+	}
+
+private:
+	SharedMemory(const SharedMemory&) = delete;
+	SharedMemory& operator=(const SharedMemory&) = delete;
+
+	unsigned char* m_Data{ nullptr };
+	size_t m_Size{ 0 };
+	bool m_Owner{ false };
+	std::string m_Name;
+#ifdef _WIN32
+	void* m_Mapping{ nullptr };
+#endif
+};
+
+//==============================================================
+// Writing side, one per machine
+//==============================================================
+class SpectrumPublisher
+{
+public:
+	bool Open(const std::string& name,int binCount,int slotCount = SPECTRUM_SHM_SLOTS);
+	void Close();
+
+	bool IsOpen() const
+	{
+		return m_Header!=nullptr;
+	}
+
+	int GetBinCount() const
+	{
+		return m_Header ? (int)m_Header->binCount : 0;
+	}
+
+	// Copies binCount values into the next slot
+	void Publish(const float* frame,double time);
+
+private:
+	SharedMemory m_Memory;
+	SpectrumShmHeader* m_Header{ nullptr };
+	uint64_t m_FrameIndex{ 0 };
+};
+
+//==============================================================
+// Reading side. Frames can be read in place: AcquireLatest hands
+// out a pointer into the ring, and IsValid afterwards says whether
+// the publisher overwrote it while it was being used.
+//==============================================================
+struct SpectrumView
+{
+	const float* bins{ nullptr };
+	uint64_t frameIndex{ 0 };
+	double time{ 0 };
+	const SpectrumShmSlot* slot{ nullptr };
+	uint64_t sequence{ 0 };
+};
+
+class SpectrumSubscriber
+{
+public:
+	bool Open(const std::string& name);
+	void Close();
+
+	int GetBinCount() const
+	{
+		return m_Header ? (int)m_Header->binCount : 0;
+	}
+
+	// Newest complete frame; false if nothing has been published yet
+	bool AcquireLatest(SpectrumView& view) const;
+	bool IsValid(const SpectrumView& view) const;
+
+	// Copying read that retries until it gets a whole frame; torn, if
+	// given, is set to the number of copies discarded on the way
+	bool ReadLatest(float* dest,uint64_t* frameIndex = nullptr,int* torn = nullptr) const;
+
+	// The publisher has closed or replaced the ring since Open; the
+	// reads above then fail until Open is called again
+	bool IsStale() const;
+
+private:
+	SharedMemory m_Memory;
+	const SpectrumShmHeader* m_Header{ nullptr };
+	uint32_t m_Generation{ 0 };
+};
+
+//==============================================================
+// Test consumer: follows a ring by name, reopening it when the
+// publisher replaces it, and reports once a second how many frames
+// arrived and how many reads had to be retried
+//==============================================================
+class SpectrumMonitor
+{
+public:
+	// Reads until `seconds` have passed, or forever when <= 0
+	void Run(const std::string& name,double seconds);
+
+private:
+	SpectrumSubscriber m_Subscriber;
+	uint64_t m_Frames{ 0 };
+	uint64_t m_Skipped{ 0 };
+	uint64_t m_Retries{ 0 };
+	uint64_t m_Failed{ 0 };
+	uint64_t m_Reopens{ 0 };
+};
@@ -0,0 +1,273 @@
+#include "SpectrumStream.h"
+#include "SpectrumCodec.h"
+
+#include <algorithm>
+#include <string.h>
+
+#ifdef _WIN32
+#define SeekFile _fseeki64
+#define TellFile _ftelli64
+#else
+#define SeekFile fseeko
+#define TellFile ftello
+#endif
+
+SpectrumStream::SpectrumStream()
+{
+	memset(&m_Header,0,sizeof(m_Header));
+}
+
+SpectrumStream::~SpectrumStream()
+{
+	Close();
+}
+
+bool SpectrumStream::Open(const std::string& path)
+{
+	Close();
+	FILE* file = fopen(path.c_str(),"rb");
+	if(!file)
+	{
+		return false;
+	}
+	SeekFile(file,0,SEEK_END);
+	uint64_t size = (uint64_t)TellFile(file);
+	SeekFile(file,0,SEEK_SET);
+	if(fread(&m_Header,sizeof(m_Header),1,file)!=1||!CheckSpectrumHeader(m_Header,size,path))
+	{
+		fclose(file);
+		memset(&m_Header,0,sizeof(m_Header));
+		return false;
+	}
+	m_File = file;
+	m_BlockFrames = GetBlockFrames(m_Header);
+	// Chunks are whole compressed blocks
+	m_ChunkFrames = std::max(1,SPECTRUM_STREAM_CHUNK_FRAMES/m_BlockFrames)*m_BlockFrames;
+	m_ChunkCount = (int)((m_Header.frameCount+m_ChunkFrames-1)/m_ChunkFrames);
+	m_Position = 0;
+	m_Quit = false;
+	// The first chunk is read here so playback starts on a hit
+	if(m_ChunkCount>0)
+	{
+		std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+		chunk->index = 0;
+		LoadChunk(0,chunk->frames);
+		m_Chunks.push_back(chunk);
+	}
+	m_Thread = std::thread(&SpectrumStream::PrefetchLoop,this);
+	return true;
+}
+
+void SpectrumStream::Close()
+{
+	if(m_Thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Quit = true;
+		}
+		m_Wake.notify_all();
+		m_Thread.join();
+	}
+	if(m_File)
+	{
+		fclose(m_File);
+		m_File = nullptr;
+	}
+	m_Chunks.clear();
+	m_Pinned.reset();
+	memset(&m_Header,0,sizeof(m_Header));
+}
+
+void SpectrumStream::SetPosition(int frame)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if(m_Position==frame)
+		{
+			return;
+		}
+		m_Position = frame;
+	}
+	m_Wake.notify_one();
+}
+
+void SpectrumStream::Preload(int frame)
+{
+	if(!m_File||frame<0||frame>=(int)m_Header.frameCount)
+	{
+		return;
+	}
+	int index = frame/m_ChunkFrames;
+	bool resident;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		resident = FindChunk(index)!=nullptr;
+	}
+	if(!resident)
+	{
+		std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+		chunk->index = index;
+		{
+			std::lock_guard<std::mutex> read(m_ReadMutex);
+			LoadChunk(index,chunk->frames);
+		}
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		AddChunk(chunk);
+	}
+	SetPosition(frame);
+}
+
+FrameSpan SpectrumStream::GetFrame(int frame)
+{
+	if(!m_File||frame<0||frame>=(int)m_Header.frameCount)
+	{
+		return FrameSpan();
+	}
+	int index = frame/m_ChunkFrames;
+	if(!m_Pinned||m_Pinned->index!=index)
+	{
+		std::shared_ptr<Chunk> chunk;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			chunk = FindChunk(index);
+			if(chunk)
+			{
+				chunk->lastUse = ++m_UseCount;
+			}
+		}
+		// The read-ahead window moves a chunk at a time
+		SetPosition(frame);
+		if(!chunk)
+		{
+			return FrameSpan();
+		}
+		m_Pinned = chunk;
+	}
+	return FrameSpan(&m_Pinned->frames[(size_t)(frame%m_ChunkFrames)*m_Header.binCount],m_Header.binCount);
+}
+
+std::shared_ptr<SpectrumStream::Chunk> SpectrumStream::FindChunk(int index) const
+{
+	for(const std::shared_ptr<Chunk>& chunk:m_Chunks)
+	{
+		if(chunk->index==index)
+		{
+			return chunk;
+		}
+	}
+	return nullptr;
+}
+
+void SpectrumStream::PrefetchLoop()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while(!m_Quit)
+	{
+		int first = std::max(0,m_Position/m_ChunkFrames);
+		int last = std::min(first+SPECTRUM_STREAM_AHEAD,m_ChunkCount-1);
+		int wanted = -1;
+		for(int index = first; index<=last&&wanted<0; ++index)
+		{
+			if(!FindChunk(index))
+			{
+				wanted = index;
+			}
+		}
+		if(wanted<0)
+		{
+			m_Wake.wait(lock);
+			continue;
+		}
+
+		lock.unlock();
+		std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+		chunk->index = wanted;
+		{
+			std::lock_guard<std::mutex> read(m_ReadMutex);
+			LoadChunk(wanted,chunk->frames);
+		}
+		lock.lock();
+		AddChunk(chunk);
+	}
+}
+
+void SpectrumStream::AddChunk(const std::shared_ptr<Chunk>& chunk)
+{
+	// A seek may have read the same chunk while the prefetch thread did
+	if(FindChunk(chunk->index))
+	{
+		return;
+	}
+	if(m_Chunks.size()>=SPECTRUM_STREAM_CHUNKS)
+	{
+		// Chunks ahead were touched last; the oldest is behind playback
+		auto oldest = std::min_element(m_Chunks.begin(),m_Chunks.end(),[](const std::shared_ptr<Chunk>& a,const std::shared_ptr<Chunk>& b)
+		{
+			return a->lastUse<b->lastUse;
+		});
+		m_Chunks.erase(oldest);
+	}
+	chunk->lastUse = ++m_UseCount;
+	m_Chunks.push_back(chunk);
+}
+
+void SpectrumStream::LoadChunk(int index,std::vector<float>& frames)
+{
+	int binCount = (int)m_Header.binCount;
+	int first = index*m_ChunkFrames;
+	int count = std::min(m_ChunkFrames,(int)m_Header.frameCount-first);
+	frames.assign((size_t)m_ChunkFrames*binCount,0.0f);
+	size_t values = (size_t)count*binCount;
+	bool ok = true;
+	if(m_Header.format==SPECTRUM_FLOAT32)
+	{
+		ok = ReadAt(m_Header.dataOffset+(uint64_t)first*binCount*sizeof(float),frames.data(),values*sizeof(float));
+	}
+	else if(m_Header.format==SPECTRUM_FLOAT16)
+	{
+		m_Raw.resize(values*sizeof(uint16_t));
+		ok = ReadAt(m_Header.dataOffset+(uint64_t)first*binCount*sizeof(uint16_t),m_Raw.data(),m_Raw.size());
+		const uint16_t* halves = (const uint16_t*)m_Raw.data();
+		for(size_t i = 0; ok&&i<values; ++i)
+		{
+			frames[i] = HalfToFloat(halves[i]);
+		}
+	}
+	else
+	{
+		// Only this chunk's slice of the offset table is read
+		int firstBlock = first/m_BlockFrames;
+		int blockCount = (count+m_BlockFrames-1)/m_BlockFrames;
+		m_Offsets.resize(blockCount+1);
+		ok = ReadAt(m_Header.dataOffset+(uint64_t)firstBlock*sizeof(uint64_t),m_Offsets.data(),m_Offsets.size()*sizeof(uint64_t));
+		ok = ok&&m_Offsets[0]<=m_Offsets[blockCount]&&m_Offsets[blockCount]<=m_Header.dataSize;
+		if(ok)
+		{
+			m_Raw.resize((size_t)(m_Offsets[blockCount]-m_Offsets[0]));
+			ok = ReadAt(m_Header.dataOffset+m_Offsets[0],m_Raw.data(),m_Raw.size());
+		}
+		for(int b = 0; ok&&b<blockCount; ++b)
+		{
+			int frameCount = std::min(m_BlockFrames,count-b*m_BlockFrames);
+			uint64_t start = m_Offsets[b]-m_Offsets[0];
+			uint64_t end = m_Offsets[b+1]-m_Offsets[0];
+			ok = start<=end&&end<=m_Raw.size()&&DecodeSpectrumBlock(&m_Raw[(size_t)start],(size_t)(end-start),frameCount,binCount,&frames[(size_t)b*m_BlockFrames*binCount],m_Scratch);
+		}
+	}
+	if(!ok)
+	{
+		// Unreadable chunks play as silence rather than stalling playback
+		std::cout<<"Spectrum chunk "<<index<<" is unreadable"<<std::endl;
+		std::fill(frames.begin(),frames.end(),0.0f);
+	}
+}
+
+bool SpectrumStream::ReadAt(uint64_t offset,void* dest,size_t size)
+{
+	if(size==0)
+	{
+		return true;
+	}
+	return SeekFile(m_File,(long long)offset,SEEK_SET)==0&&fread(dest,1,size,m_File)==size;
+}
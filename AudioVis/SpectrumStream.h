@@ -0,0 +1,106 @@
+#pragma once
+
+#include "FrameSpan.h"
+#include "SpectrumFile.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+//==============================================================
+// Reads a .avspec file of any length in chunks of frames, with a
+// fixed number of decoded chunks resident. A prefetch thread keeps
+// the chunks just ahead of the playback position loaded, so the
+// render thread only ever takes a short lock and never waits on
+// the disk; a frame that is not loaded yet reads as empty. Seeks
+// call Preload, which reads the one chunk they land in straight away.
+//==============================================================
+class SpectrumStream
+{
+public:
+	SpectrumStream();
+	~SpectrumStream();
+
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const
+	{
+		return m_File!=nullptr;
+	}
+
+	int GetFrameCount() const
+	{
+		return (int)m_Header.frameCount;
+	}
+
+	int GetBinCount() const
+	{
+		return (int)m_Header.binCount;
+	}
+
+	int GetHop() const
+	{
+		return (int)m_Header.hop;
+	}
+
+	int FrameAtTime(double seconds) const
+	{
+		return SpectrumFrameAtTime(seconds,(int)m_Header.sampleRate,GetHop(),GetFrameCount());
+	}
+
+	// Moves the read-ahead window, e.g. ahead of a seek
+	void SetPosition(int frame);
+	// Reads the chunk holding frame now unless it is resident, then moves
+	// the window there, so the next GetFrame(frame) is a hit. Blocks for
+	// one chunk read; meant for user actions such as seeking.
+	void Preload(int frame);
+
+	// Also moves the window to frame. The span stays valid until the next
+	// GetFrame; call both from one thread only.
+	FrameSpan GetFrame(int frame);
+
+private:
+	struct Chunk
+	{
+		int index{ -1 };
+		unsigned int lastUse{ 0 };
+		std::vector<float> frames;
+	};
+
+	void PrefetchLoop();
+	std::shared_ptr<Chunk> FindChunk(int index) const;
+	// With m_Mutex held: adds the chunk unless it is already resident,
+	// evicting the least recently used one if the cache is full
+	void AddChunk(const std::shared_ptr<Chunk>& chunk);
+	void LoadChunk(int index,std::vector<float>& frames);
+	bool ReadAt(uint64_t offset,void* dest,size_t size);
+
+	FILE* m_File{ nullptr };
+	AvSpecHeader m_Header;
+	int m_BlockFrames{ 0 };
+	int m_ChunkFrames{ 0 };
+	int m_ChunkCount{ 0 };
+
+	std::thread m_Thread;
+	std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::vector<std::shared_ptr<Chunk>> m_Chunks;
+	int m_Position{ 0 };
+	unsigned int m_UseCount{ 0 };
+	bool m_Quit{ false };
+
+	// Render thread only: keeps the chunk behind the last span alive
+	std::shared_ptr<const Chunk> m_Pinned;
+
+	// LoadChunk's file position and buffers; the prefetch thread and
+	// Preload both read chunks
+	std::mutex m_ReadMutex;
+	std::vector<uint8_t> m_Raw;
+	std::vector<uint8_t> m_Scratch;
+	std::vector<uint64_t> m_Offsets;
+};
@@ -0,0 +1,49 @@
+#include "SpectrumTexture.h"
+
+bool SpectrumTexture::Init()
+{
+	if(!m_HeightBuffer.Init())
+	{
+		return false;
+	}
+	glGenTextures(1,&m_Texture);
+	glBindTexture(GL_TEXTURE_BUFFER,m_Texture);
+	// Follows the buffer through the orphaning StreamBuffer does to grow
+	glTexBuffer(GL_TEXTURE_BUFFER,GL_R32F,m_HeightBuffer.GetBuffer());
+	glBindTexture(GL_TEXTURE_BUFFER,0);
+
+	glGenVertexArrays(1,&m_VAO);
+	return m_Texture!=0&&m_VAO!=0;
+}
+
+void SpectrumTexture::Release()
+{
+	if(m_VAO)
+	{
+		glDeleteVertexArrays(1,&m_VAO);
+		m_VAO = 0;
+	}
+	if(m_Texture)
+	{
+		glDeleteTextures(1,&m_Texture);
+		m_Texture = 0;
+	}
+	m_HeightBuffer.Release();
+}
+
+GLint SpectrumTexture::Upload(FrameSpan heights)
+{
+	return m_HeightBuffer.Upload(heights.data(),heights.size(),sizeof(float));
+}
+
+void SpectrumTexture::Draw(GLenum mode,GLsizei count,GLsizei instances)
+{
+	if(count>0&&instances>0)
+	{
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_BUFFER,m_Texture);
+		glBindVertexArray(m_VAO);
+		glDrawArraysInstanced(mode,0,count,instances);
+	}
+	m_HeightBuffer.EndFrame();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "FrameSpan.h"
+#include "StreamBuffer.h"
+#include "GL/glew.h"
+
+//==============================================================
+// A frame's heights as a buffer texture, for shapes whose vertex
+// shaders build all their geometry from gl_VertexID. Only the
+// heights are uploaded, four bytes a bin, and the draws have no
+// vertex attributes at all.
+//
+// The texture covers the whole stream buffer (GL 3.3 has no
+// glTexBufferRange), so shaders read height i at uFirst+i:
+//
+//   uniform samplerBuffer uHeights;   texture unit 0
+//   uniform int uFirst;               returned by Upload
+//==============================================================
+class SpectrumTexture
+{
+public:
+	bool Init();
+	void Release();
+
+	// Index of the frame's first height in the texture, -1 if
+	// there is nothing to draw
+	GLint Upload(FrameSpan heights);
+
+	// Draws count vertices, instances times, from the bound program with
+	// the heights on unit 0, then ends the frame. Upload first, draw
+	// before the next upload.
+	void Draw(GLenum mode,GLsizei count,GLsizei instances = 1);
+
+private:
+	GLuint m_Texture{ 0 };
+	// Core profile draws need a VAO bound, even an empty one
+	GLuint m_VAO{ 0 };
+	StreamBuffer m_HeightBuffer;
+};
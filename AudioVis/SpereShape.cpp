@@ -26,71 +26,52 @@ bool SpereShape::Init()
 	shader = LoadShaders("Shaders/AudioRect.vs","Shaders/AudioRect.fs");
 	if(shader>0)
 	{
-		MVPID = glGetUniformLocation(shader,"MVP");
+		m_ModelID = glGetUniformLocation(shader,"uModel");
 	}
-	return true;
+	m_Model = glm::translate(glm::mat4(1.0f),glm::vec3(0,0,-5));
+	return GenVAO();
 }
 
-void SpereShape::Draw(Visualizer* visualizer)
+void SpereShape::Release()
 {
-	auto heightlist = visualizer->GetHeightList(m_Framecount%m_TotalNum);
-	int average = 10;
-	vector<float> templist;
-	float tempnum = 0;
-	for(int i = 0; i<heightlist.size(); i++)
+	if(m_VAO)
 	{
-		auto temp = i%average;
-		if(temp==0&&i>0)
-		{
-			templist.push_back(tempnum/average);
-			tempnum = 0;
-		}
-		else
-		{
-			tempnum += heightlist[i];
-		}
-		if(i==heightlist.size()-1)
-		{
-			templist.push_back(tempnum/(temp+1));
-		}
+		glDeleteVertexArrays(1,&m_VAO);
+		m_VAO = 0;
 	}
+	m_VertexBuffer.Release();
+}
 
-	auto vao = GenVAO(templist);
-	glm::mat4 Projection = glm::perspective(glm::radians(60.0f),1280.0f/720.0f,0.1f,1000.0f);
-	glm::mat4 View = glm::lookAt(
-		glm::vec3(0,0,0),
-		glm::vec3(0,0,-1),
-		glm::vec3(0,1,0)
-	);
-	glm::mat4 Model = glm::mat4(1.0f);
-	Model = glm::translate(Model,glm::vec3(0,0,-5));
-	glm::mat4 MVP = Projection*View*Model;
+void SpereShape::Draw(Visualizer* visualizer)
+{
+	auto heightlist = visualizer->GetHeightBands(visualizer->GetCurrentFrame(),32);
+	GenerateNoisySphere(heightlist,m_SphereRow,m_SphereCol);
+	GLint firstVertex = m_VertexBuffer.Upload(vertices.data(),vertices.size(),sizeof(ColorVertex));
+	if(firstVertex<0)
+	{
+		return;
+	}
 	glClearColor(0.3,0.3,0.3,1.0);
 	glUseProgram(shader);
-	glUniformMatrix4fv(MVPID,1,GL_FALSE,&MVP[0][0]);
-	glBindVertexArray(vao);
-	glDrawElements(GL_TRIANGLES,indices.size(),GL_UNSIGNED_SHORT,&indices[0]);
-	glDeleteVertexArrays(1,&vao);
-	m_Framecount++;
+	glUniformMatrix4fv(m_ModelID,1,GL_FALSE,&m_Model[0][0]);
+	glBindVertexArray(m_VAO);
+	IndexTopology::Get(TOPOLOGY_GRID_STRIP,m_SphereRow,m_SphereCol).Draw(firstVertex);
+	m_VertexBuffer.EndFrame();
 }
 
-unsigned int SpereShape::GenVAO(const std::vector<float>& heigthlist)
+bool SpereShape::GenVAO()
 {
-	unsigned int VBO,VAO;
-	glGenVertexArrays(1,&VAO);
-	glGenBuffers(1,&VBO);
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER,VBO);
-	// ܺͲԪظ
-	GenerateNoisySphere(heigthlist,m_SphereRow,m_SphereCol);
-	glBufferData(GL_ARRAY_BUFFER,sizeof(glm::vec3)*vertices.size(),&vertices[0],GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,6*sizeof(float),(void*)0);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,6*sizeof(float),(void*)(3*sizeof(float)));
-	glEnableVertexAttribArray(1);
-	return VAO;
+	if(!m_VertexBuffer.Init())
+	{
+		return false;
+	}
+	glGenVertexArrays(1,&m_VAO);
+	glBindVertexArray(m_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER,m_VertexBuffer.GetBuffer());
+	// The grid only depends on the resolution, so its indices never change
+	IndexTopology::Get(TOPOLOGY_GRID_STRIP,m_SphereRow,m_SphereCol).Bind();
+	ColorVertex::GetLayout().Apply();
+	return true;
 }
 
 float dot(const int* g,float x,float y,float z)
@@ -225,53 +206,40 @@ float SimplexNoise(float xin,float yin,float zin)
 }
 
 // ɺŶ 
-void SpereShape::GenerateNoisySphere(const std::vector<float>& heigthlist,int stacks,int slices)
+void SpereShape::GenerateNoisySphere(FrameSpan heigthlist,int stacks,int slices)
 {
 	// 嶥
 	if(heigthlist.empty())return;
 	vertices.clear();
-	indices.clear();
 
 	auto radius = m_fSphereRadius;
 	float sum = std::accumulate(heigthlist.begin(),heigthlist.end(),0.0f);
 	auto qz = sum/heigthlist.size();
 	radius += qz;
 	float noise = (rand()%1000)/1000.0f*0.5f;  // һŶֵ
+	// Longitude goes once round; latitude half round, from the south pole
+	const PolarBasis& lonBasis = PolarBasis::Get(slices);
+	const PolarBasis& latBasis = PolarBasis::Get(2*stacks);
 	for(int i = 0; i<=stacks; ++i)
 	{
-		float lat = M_PI*(i/(float)stacks-0.5f); // γ
+		// γ pi*i/stacks-pi/2
+		float cosLat = latBasis[i].y;
+		float sinLat = -latBasis[i].x;
 		for(int j = 0; j<=slices; ++j)
 		{
-			float lon = 2*M_PI*(j/(float)slices); // 
+			// 
+			const glm::vec2& lon = lonBasis[j];
 
 			// 
-			auto x = radius*cos(lat)*cos(lon);
-			auto y = radius*cos(lat)*sin(lon);
-			auto z = radius*sin(lat);
+			auto x = radius*cosLat*lon.x;
+			auto y = radius*cosLat*lon.y;
+			auto z = radius*sinLat;
 			auto offset = SimplexNoise(x,y,z)*qz*5.0;
 			if(offset<1)
 			{
 				offset = 1;
 			}
-			vertices.push_back(glm::vec3(x*offset,y*offset,z*offset));
-			vertices.push_back(glm::vec4(noise,noise,0.6,1));
-		}
-	}
-	// 
-	for(int i = 0; i<stacks; ++i)
-	{
-		for(int j = 0; j<slices; ++j)
-		{
-			int first = (i*(slices+1))+j;
-			int second = first+slices+1;
-
-			indices.push_back(first);
-			indices.push_back(second);
-			indices.push_back(first+1);
-
-			indices.push_back(second);
-			indices.push_back(second+1);
-			indices.push_back(first+1);
+			vertices.emplace_back(glm::vec3(x*offset,y*offset,z*offset),glm::vec3(noise,noise,0.6));
 		}
 	}
 }
\ No newline at end of file
@@ -7,6 +7,10 @@
 
 #include "AudioVis.h"
 #include "DrawBase.h"
+#include "IndexTopology.h"
+#include "PolarBasis.h"
+#include "StreamBuffer.h"
+#include "VertexFormat.h"
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
@@ -35,15 +39,20 @@ public:
 
 	virtual void Draw(Visualizer* visualizer)override;
 
+	virtual void Release()override;
+
 private:
-	unsigned int GenVAO(const std::vector<float>& heigthlist);
-	void GenerateNoisySphere(const std::vector<float>& heigthlist,int stacks,int slices);
+	bool GenVAO();
+	void GenerateNoisySphere(FrameSpan heigthlist,int stacks,int slices);
 private:
 	GLuint shader;
-	GLuint MVPID;
+	// Set on each draw: the program is shared by source with other shapes
+	GLint m_ModelID{ -1 };
+	glm::mat4 m_Model{ 1.0f };
 	float m_fSphereRadius = 1;
 	int m_SphereRow = 61;
 	int m_SphereCol = 60;
-	std::vector<glm::vec3> vertices;
-	std::vector<unsigned int> indices;
+	std::vector<ColorVertex> vertices;
+	GLuint m_VAO{ 0 };
+	StreamBuffer m_VertexBuffer;
 };
@@ -0,0 +1,132 @@
+#include "StreamBuffer.h"
+
+#include <string.h>
+
+StreamBuffer::StreamBuffer()
+{
+	for(GLsync& fence:m_Fences)
+	{
+		fence = nullptr;
+	}
+}
+
+StreamBuffer::~StreamBuffer()
+{
+}
+
+bool StreamBuffer::Init(size_t frameSize)
+{
+	Release();
+	glGenBuffers(1,&m_Buffer);
+	if(!m_Buffer)
+	{
+		std::cout<<"Unable to create a stream buffer"<<std::endl;
+		return false;
+	}
+	Resize(frameSize);
+	return true;
+}
+
+void StreamBuffer::Release()
+{
+	for(GLsync& fence:m_Fences)
+	{
+		if(fence)
+		{
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+	if(m_Buffer)
+	{
+		glDeleteBuffers(1,&m_Buffer);
+		m_Buffer = 0;
+	}
+	m_FrameSize = 0;
+}
+
+void StreamBuffer::Resize(size_t frameSize)
+{
+	// Orphaning: the driver keeps the old storage alive for draws still
+	// in flight, so the fences on it no longer matter
+	for(GLsync& fence:m_Fences)
+	{
+		if(fence)
+		{
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+	m_FrameSize = frameSize;
+	glBindBuffer(GL_COPY_WRITE_BUFFER,m_Buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER,(GLsizeiptr)(m_FrameSize*STREAM_BUFFER_FRAMES),NULL,GL_STREAM_DRAW);
+	m_Region = 0;
+	m_Cursor = 0;
+	m_Waited = true;
+}
+
+void StreamBuffer::WaitForRegion(int region)
+{
+	GLsync& fence = m_Fences[region];
+	if(!fence)
+	{
+		return;
+	}
+	// Normally signalled long ago: the region was drawn from two frames back
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while(glClientWaitSync(fence,flags,1000000)==GL_TIMEOUT_EXPIRED)
+	{
+		flags = 0;
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+GLint StreamBuffer::Upload(const void* data,size_t count,size_t stride)
+{
+	if(!m_Buffer||count==0||stride==0)
+	{
+		return -1;
+	}
+	size_t size = count*stride;
+	size_t regionStart = m_Region*m_FrameSize;
+	// Offsets are kept whole strides from the buffer start
+	size_t offset = (regionStart+m_Cursor+stride-1)/stride*stride;
+	if(offset+size>regionStart+m_FrameSize)
+	{
+		// Twice what this frame needs, so growth settles quickly
+		Resize(std::max(m_FrameSize*2,(m_Cursor+size+stride)*2));
+		offset = 0;
+	}
+	if(!m_Waited)
+	{
+		WaitForRegion(m_Region);
+		m_Waited = true;
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER,m_Buffer);
+	void* dest = glMapBufferRange(GL_COPY_WRITE_BUFFER,(GLintptr)offset,(GLsizeiptr)size,GL_MAP_WRITE_BIT|GL_MAP_INVALIDATE_RANGE_BIT|GL_MAP_UNSYNCHRONIZED_BIT);
+	if(!dest)
+	{
+		return -1;
+	}
+	memcpy(dest,data,size);
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	m_Cursor = offset+size-m_Region*m_FrameSize;
+	return (GLint)(offset/stride);
+}
+
+void StreamBuffer::EndFrame()
+{
+	if(!m_Buffer)
+	{
+		return;
+	}
+	if(m_Fences[m_Region])
+	{
+		glDeleteSync(m_Fences[m_Region]);
+	}
+	m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+	m_Region = (m_Region+1)%STREAM_BUFFER_FRAMES;
+	m_Cursor = 0;
+	m_Waited = false;
+}
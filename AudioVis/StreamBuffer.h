@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "GL/glew.h"
+
+#include <stddef.h>
+
+//==============================================================
+// One GL buffer for data rewritten every frame. The buffer is
+// split into STREAM_BUFFER_FRAMES regions used in turn; each frame
+// writes into its own region with an unsynchronized map, and a
+// fence keeps it from reusing a region the GPU may still be
+// reading. The buffer name never changes, so VAOs that point at it
+// are built once.
+//==============================================================
+class StreamBuffer
+{
+public:
+	StreamBuffer();
+	~StreamBuffer();
+
+	// frameSize is the starting size of a region; it grows on demand
+	bool Init(size_t frameSize = STREAM_BUFFER_SIZE);
+	// Needs the GL context, so it is not left to the destructor
+	void Release();
+
+	GLuint GetBuffer() const
+	{
+		return m_Buffer;
+	}
+
+	// Copies count elements of stride bytes into this frame's region.
+	// Returns the index of the first one counted in strides from the
+	// start of the buffer, ready for glDrawArrays' first or, times
+	// stride, glDrawElements' offset. -1 if the upload failed.
+	// A region that is too small is grown by orphaning the buffer,
+	// which drops what this frame uploaded before, so draw from each
+	// upload before making the next one.
+	GLint Upload(const void* data,size_t count,size_t stride);
+
+	// Call after the frame's draws: fences the region and moves on
+	void EndFrame();
+
+private:
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	void Resize(size_t frameSize);
+	void WaitForRegion(int region);
+
+	GLuint m_Buffer{ 0 };
+	size_t m_FrameSize{ 0 };
+	int m_Region{ 0 };
+	size_t m_Cursor{ 0 };
+	bool m_Waited{ false };
+	GLsync m_Fences[STREAM_BUFFER_FRAMES];
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//==============================================================
+// Fixed set of worker threads draining a FIFO of jobs.
+// Defaults to one worker per hardware thread.
+//==============================================================
+class ThreadPool
+{
+public:
+	explicit ThreadPool(unsigned int threadCount = 0)
+	{
+		if(threadCount==0)
+		{
+			threadCount = std::thread::hardware_concurrency();
+		}
+		if(threadCount==0)
+		{
+			threadCount = 1;
+		}
+		for(unsigned int i = 0; i<threadCount; ++i)
+		{
+			m_Workers.emplace_back(&ThreadPool::WorkerLoop,this);
+		}
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Quit = true;
+		}
+		m_Wake.notify_all();
+		for(auto& worker:m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	unsigned int GetThreadCount() const
+	{
+		return (unsigned int)m_Workers.size();
+	}
+
+	void Submit(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Jobs.push_back(std::move(job));
+			++m_Pending;
+		}
+		m_Wake.notify_one();
+	}
+
+	// Blocks until every submitted job has finished
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Idle.wait(lock,[this]
+		{
+			return m_Pending==0;
+		});
+	}
+
+private:
+	void WorkerLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while(true)
+		{
+			m_Wake.wait(lock,[this]
+			{
+				return m_Quit||!m_Jobs.empty();
+			});
+			if(m_Jobs.empty())
+			{
+				return;
+			}
+			std::function<void()> job = std::move(m_Jobs.front());
+			m_Jobs.pop_front();
+			lock.unlock();
+			job();
+			lock.lock();
+			if(--m_Pending==0)
+			{
+				m_Idle.notify_all();
+			}
+		}
+	}
+
+	std::vector<std::thread> m_Workers;
+	std::deque<std::function<void()>> m_Jobs;
+	std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::condition_variable m_Idle;
+	size_t m_Pending{ 0 };
+	bool m_Quit{ false };
+};
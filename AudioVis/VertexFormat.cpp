@@ -0,0 +1,62 @@
+#include "VertexFormat.h"
+#include "glm/packing.hpp"
+#include "glm/gtc/packing.hpp"
+
+#include <stddef.h>
+
+VertexLayout::VertexLayout(GLsizei stride,std::initializer_list<VertexAttribute> attributes)
+	: m_Stride(stride),m_Attributes(attributes)
+{
+}
+
+void VertexLayout::Apply(size_t baseOffset) const
+{
+	for(const VertexAttribute& attribute:m_Attributes)
+	{
+		glVertexAttribPointer(attribute.location,attribute.size,attribute.type,attribute.normalized,m_Stride,(void*)(baseOffset+attribute.offset));
+		glEnableVertexAttribArray(attribute.location);
+	}
+}
+
+ColorVertex::ColorVertex(const glm::vec3& position,const glm::vec3& color)
+{
+	for(int i = 0; i<3; ++i)
+	{
+		this->position[i] = glm::packHalf1x16(position[i]);
+	}
+	this->position[3] = 0;
+	this->color = glm::packUnorm4x8(glm::vec4(color,1.0f));
+}
+
+const VertexLayout& ColorVertex::GetLayout()
+{
+	static const VertexLayout layout(sizeof(ColorVertex),
+	{
+		{ 0,3,GL_HALF_FLOAT,GL_FALSE,offsetof(ColorVertex,position) },
+		{ 1,4,GL_UNSIGNED_BYTE,GL_TRUE,offsetof(ColorVertex,color) },
+	});
+	return layout;
+}
+
+MeshVertex::MeshVertex(const glm::vec3& position,const glm::vec3& normal,const glm::vec2& uv)
+{
+	glm::uint64 packed = glm::packSnorm4x16(glm::vec4(position,0.0f));
+	for(int i = 0; i<4; ++i)
+	{
+		this->position[i] = (int16_t)(packed>>(16*i));
+	}
+	this->normal = glm::packSnorm3x10_1x2(glm::vec4(normal,0.0f));
+	this->uv[0] = glm::packHalf1x16(uv.x);
+	this->uv[1] = glm::packHalf1x16(uv.y);
+}
+
+const VertexLayout& MeshVertex::GetLayout()
+{
+	static const VertexLayout layout(sizeof(MeshVertex),
+	{
+		{ 0,3,GL_SHORT,GL_TRUE,offsetof(MeshVertex,position) },
+		{ 2,4,GL_INT_2_10_10_10_REV,GL_TRUE,offsetof(MeshVertex,normal) },
+		{ 3,2,GL_HALF_FLOAT,GL_FALSE,offsetof(MeshVertex,uv) },
+	});
+	return layout;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "AudioVis.h"
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+#include <initializer_list>
+#include <stdint.h>
+#include <vector>
+
+//==============================================================
+// One vertex attribute: where it sits in a vertex and how GL
+// should widen it to the shader's floats
+//==============================================================
+struct VertexAttribute
+{
+	GLuint location;
+	GLint size;
+	GLenum type;
+	GLboolean normalized;
+	GLuint offset;
+};
+
+//==============================================================
+// The attributes of one vertex format. Apply points and enables
+// them all for the buffer bound to GL_ARRAY_BUFFER, so a VAO is
+// set up with one call per format instead of one per attribute.
+//==============================================================
+class VertexLayout
+{
+public:
+	VertexLayout(GLsizei stride,std::initializer_list<VertexAttribute> attributes);
+
+	GLsizei GetStride() const
+	{
+		return m_Stride;
+	}
+
+	// baseOffset is in bytes from the start of the buffer
+	void Apply(size_t baseOffset = 0) const;
+
+private:
+	GLsizei m_Stride;
+	std::vector<VertexAttribute> m_Attributes;
+};
+
+//==============================================================
+// 12 bytes: half float position, padded to four halves, and an
+// RGBA8 colour. For the CPU-built coloured shapes drawn with
+// AudioRect.vs (location 0 position, 1 colour), which used 24.
+// Halves keep about three significant digits, plenty for scenes
+// a few units across.
+//==============================================================
+struct ColorVertex
+{
+	uint16_t position[4];
+	uint32_t color;
+
+	ColorVertex()
+	{
+	}
+
+	ColorVertex(const glm::vec3& position,const glm::vec3& color);
+
+	static const VertexLayout& GetLayout();
+};
+
+//==============================================================
+// 16 bytes: a point on the unit sphere as snorm16, its normal
+// packed 10:10:10:2 and a half float uv. For NoiseBall.vs
+// (locations 0, 2 and 3), which scales the sphere to its radius.
+//==============================================================
+struct MeshVertex
+{
+	int16_t position[4];
+	uint32_t normal;
+	uint16_t uv[2];
+
+	MeshVertex()
+	{
+	}
+
+	MeshVertex(const glm::vec3& position,const glm::vec3& normal,const glm::vec2& uv);
+
+	static const VertexLayout& GetLayout();
+};
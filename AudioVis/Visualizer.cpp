@@ -1,5 +1,10 @@
 #include "Visualizer.h"
+#include "AudioObject.h"
+#include "IndexTopology.h"
+#include "PolarBasis.h"
 #include "Shader.hpp"
+#include "SpectrumIO.h"
+#include <glm/gtc/matrix_transform.hpp>
 #include <fstream>
 #include <iostream>
 
@@ -9,24 +14,96 @@ Visualizer::Visualizer(int width,int height)
 	windowWidth = width;
 	windowHeight = height;
 	lastTimeStamp = high_resolution_clock::now();
+	m_StartTime = steady_clock::now();
 	m_DrawBase = GetDrawObject();
 
-	std::ifstream jfile("Resources/audioData.txt");
-	jfile>>m_JsonData;
+	// The mapped file opens in constant time; parsing the JSON is the slow fallback
+	if(m_SpectrumFile.Open("Resources/audioData.avspec"))
+	{
+		m_FrameCount = m_SpectrumFile.GetFrameCount();
+		m_BinCount = m_SpectrumFile.GetBinCount();
+		m_SampleRate = m_SpectrumFile.GetSampleRate();
+		m_Hop = m_SpectrumFile.GetHop();
+		// Compressed formats are decoded block by block in GetHeightList
+		if(m_SpectrumFile.GetFormat()==SPECTRUM_FLOAT32 && m_FrameCount>0)
+		{
+			m_Frames = m_SpectrumFile.GetFrame(0);
+		}
+	}
+	else if(LoadSpectrumJson("Resources/audioData.txt",m_Spectrum))
+	{
+		m_FrameCount = m_Spectrum.frameCount;
+		m_BinCount = m_Spectrum.binCount;
+		m_Frames = m_Spectrum.frames.data();
+	}
+	m_Pyramid.Reset(m_BinCount);
 }
 
-vector<float> Visualizer::GetHeightList(int index)
+void Visualizer::SetPlaybackTime(double seconds)
 {
-	if(index>=0 && m_JsonData.size()>index)
+	m_HasPlaybackTime = true;
+	// The bundled spectrum is shorter than most tracks, so it loops
+	m_CurrentFrame = std::max(SpectrumFrameAtTime(seconds,m_SampleRate,m_Hop,m_FrameCount,true),0);
+}
+
+double Visualizer::TakeSeekRequest()
+{
+	double seek = m_SeekRequest;
+	m_SeekRequest = 0;
+	return seek;
+}
+
+void Visualizer::OnKey(GLFWwindow* window,int key,int scancode,int action,int mods)
+{
+	Visualizer* visualizer = (Visualizer*)glfwGetWindowUserPointer(window);
+	if(action==GLFW_RELEASE)
 	{
-		return m_JsonData[index];
+		return;
 	}
-	else
+	if(key==GLFW_KEY_LEFT)
+	{
+		visualizer->m_SeekRequest -= SEEK_STEP_SECONDS;
+	}
+	else if(key==GLFW_KEY_RIGHT)
+	{
+		visualizer->m_SeekRequest += SEEK_STEP_SECONDS;
+	}
+}
+
+FrameSpan Visualizer::GetHeightList(int index) const
+{
+	if(!m_SourceFrame.empty())
+	{
+		return index==m_CurrentFrame ? m_SourceFrame : FrameSpan();
+	}
+	if(index<0 || index>=m_FrameCount)
+	{
+		return FrameSpan();
+	}
+	if(!m_Frames)
 	{
-		vector<float> temp;
-		return temp;
+		return FrameSpan(m_SpectrumFile.GetFrame(index),m_BinCount);
 	}
+	return FrameSpan(m_Frames+(size_t)index*m_BinCount,m_BinCount);
 }
+
+FrameSpan Visualizer::GetHeightBands(int index,int bandCount) const
+{
+	if(!m_SourceFrame.empty())
+	{
+		if(index!=m_CurrentFrame)
+		{
+			return FrameSpan();
+		}
+		return m_SourcePyramid.GetLevel(index,m_SourcePyramid.LevelForBands(bandCount),m_SourceFrame);
+	}
+	if(index<0 || index>=m_FrameCount)
+	{
+		return FrameSpan();
+	}
+	return m_Pyramid.GetLevel(index,m_Pyramid.LevelForBands(bandCount),GetHeightList(index));
+}
+
 DrawBase* Visualizer::GetDrawObject()
 {
 	if(DEMOTYPE==0)
@@ -68,6 +145,14 @@ Visualizer::~Visualizer()
 
 void Visualizer::Teardown()
 {
+	if(m_DrawBase)
+	{
+		m_DrawBase->Release();
+	}
+	m_FrameUniforms.Release();
+	IndexTopology::ReleaseAll();
+	PolarBasis::ReleaseAll();
+	ReleaseShaders();
 	glDeleteVertexArrays(1,&vertexArrayID);
 	glfwTerminate();
 }
@@ -80,6 +165,19 @@ bool Visualizer::Init()
 		return false;
 	}
 	InitVAO();
+	if(!m_FrameUniforms.Init())
+	{
+		cout<<"Frame uniform buffer creation failed"<<endl;
+		return false;
+	}
+	// The window does not resize, so the camera is set once
+	glm::mat4 View = glm::lookAt(
+		glm::vec3(0,0,0),
+		glm::vec3(0,0,-1),
+		glm::vec3(0,1,0)
+	);
+	glm::mat4 Projection = glm::perspective(glm::radians(60.0f),(float)windowWidth/windowHeight,0.1f,1000.0f);
+	m_FrameUniforms.SetCamera(View,Projection);
 	if(!m_DrawBase||!m_DrawBase->Init())
 	{
 		return false;
@@ -117,6 +215,8 @@ bool Visualizer::InitWindow()
 	}
 
 	glfwMakeContextCurrent(window);
+	glfwSetWindowUserPointer(window,this);
+	glfwSetKeyCallback(window,OnKey);
 
 	// Initialize GLEW
 	glewExperimental = true; // Needed for core profile
@@ -158,8 +258,60 @@ void Visualizer::InitVAO()
 }
 
 
-void Visualizer::Update(const AudioObject& audioObject)
+void Visualizer::PollEvents()
 {
+	glfwPollEvents();
+}
+
+void Visualizer::SetVsync(bool enabled)
+{
+	glfwSwapInterval(enabled ? 1 : 0);
+}
+
+int Visualizer::GetRefreshRate() const
+{
+	const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+	return mode ? mode->refreshRate : 60;
+}
+
+void Visualizer::Update(AudioObject& audioObject)
+{
+	// Scrubbing moves the track's own frame with it
+	Update(audioObject.GetSpectrumFrame(),audioObject.GetPlayingTime());
+}
+
+void Visualizer::Update(FrameSpan frame,double seconds)
+{
+	if(frame.empty())
+	{
+		m_SourceFrame = FrameSpan();
+		SetPlaybackTime(seconds);
+	}
+	else
+	{
+		if((int)frame.size()!=m_SourceBinCount)
+		{
+			m_SourceBinCount = (int)frame.size();
+			m_SourcePyramid.Reset(m_SourceBinCount);
+		}
+		m_SourceFrame = frame;
+		m_HasPlaybackTime = true;
+		m_SourceIndex = (m_SourceIndex+1)&0x7FFFFFFF;
+		m_CurrentFrame = m_SourceIndex;
+	}
+	Update();
+}
+
+void Visualizer::Update()
+{
+	double seconds = duration<double>(steady_clock::now()-m_StartTime).count();
+	if(!m_HasPlaybackTime)
+	{
+		m_CurrentFrame = std::max(SpectrumFrameAtTime(seconds,m_SampleRate,m_Hop,m_FrameCount,true),0);
+	}
+	// Loudness is the frame mean, the top pyramid level
+	FrameSpan mean = GetHeightBands(m_CurrentFrame,1);
+	m_FrameUniforms.Update(seconds,mean.empty() ? 0.0f : mean[0]);
 	// Clear the screen
 	glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 	if(m_DrawBase)
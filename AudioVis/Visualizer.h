@@ -13,20 +13,21 @@
 #include "RectShape.h"
 #include "RingRectShape.h"
 #include "DrawBase.h"
+#include "FrameUniforms.h"
 #include "LineAreaShape.h"
 #include "NoiseSpereBall.h"
+#include "SpectrumFile.h"
+#include "SpectrumPyramid.h"
 #include <stdio.h>
 #include <chrono>	
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
-#include "json.hpp"
 
 using namespace std;
 using namespace glm;
 using namespace chrono;
 class AudioObject;
-using json = nlohmann::json;
 
 //0 𶯵ľβʾ
 //1 Բβʾ
@@ -43,18 +44,44 @@ public:
 	Visualizer(int width, int height);
 	~Visualizer();
 	bool Init();
-	void Update(const AudioObject& audioObject);
+	// Draws the object's own spectrum frame at its playing time; the bundled
+	// spectrum only stands in when it has none (live input)
+	void Update(AudioObject& audioObject);
+	// Draws this frame of the audio actually playing rather than the bundled
+	// spectrum; an empty frame falls back to the bundled one at `seconds`
+	void Update(FrameSpan frame,double seconds);
+	void Update();
+	// Keeps the window responsive on frames the scheduler skips
+	void PollEvents();
+	void SetVsync(bool enabled);
+	int GetRefreshRate() const;
 	const double& GetDeltaTime() const
 	{
 		return deltaTime;
 	}
-	vector<float> GetHeightList(int index);
+	// Shows the frame at this playback time from now on. Until it is first
+	// called the frames follow the wall clock from construction, looping.
+	void SetPlaybackTime(double seconds);
+	// Frame the visuals should draw this update
+	int GetCurrentFrame() const
+	{
+		return m_CurrentFrame;
+	}
+	// Seconds the user asked to scrub by since the last call (arrow keys)
+	double TakeSeekRequest();
+
+	// Frame index of the loaded spectrum; empty when out of range
+	FrameSpan GetHeightList(int index) const;
+	// The same frame averaged down to the coarsest pyramid level with at
+	// least bandCount bands; bandCount 1 gives the frame mean
+	FrameSpan GetHeightBands(int index,int bandCount) const;
 
 private:
 	bool InitWindow();
 	void InitVAO();
 	void Teardown();
 	DrawBase* GetDrawObject();
+	static void OnKey(GLFWwindow* window,int key,int scancode,int action,int mods);
 private:
 
 	GLFWwindow* window;
@@ -70,8 +97,31 @@ private:
 	RingRectShape m_RingRectShape;
 	NoiseSpereBall m_NoiseSpereBall;
 	DrawBase* m_DrawBase;
+	// Camera and per-frame globals every program reads
+	FrameUniforms m_FrameUniforms;
 	double						deltaTime{ 0 };
 	time_point<steady_clock>	lastTimeStamp;
-	json m_JsonData;
+	// Frames x bins, row major: mapped from a float32 audioData.avspec in
+	// place or loaded from audioData.txt into m_Spectrum. Null for
+	// compressed .avspec files, which go through the file's block cache.
+	SpectrumFile m_SpectrumFile;
+	SpectrumData m_Spectrum;
+	const float* m_Frames{ nullptr };
+	int m_FrameCount{ 0 };
+	int m_BinCount{ 0 };
+	mutable SpectrumPyramid m_Pyramid;
+	// The frame handed to Update, shown instead of the bundled spectrum while
+	// not empty. Each gets a new index, never reused, so its pyramid is
+	// built once and never mistaken for an older frame's.
+	FrameSpan m_SourceFrame;
+	int m_SourceIndex{ 0 };
+	int m_SourceBinCount{ 0 };
+	mutable SpectrumPyramid m_SourcePyramid;
+	int m_SampleRate{ 0 };
+	int m_Hop{ 0 };
+	int m_CurrentFrame{ 0 };
+	bool m_HasPlaybackTime{ false };
+	time_point<steady_clock> m_StartTime;
+	double m_SeekRequest{ 0 };
 	vector<float> m_AudioData;
 };
\ No newline at end of file